@@ -1,8 +1,14 @@
 #include "apt.h"
 
+#include <algorithm>
+
 #include <Kokkos_Core.hpp>
 
+#include "apt/archive.h"
+#include "apt/mapping_cache.h"
 #include "optimization/optimizer.h"
+#include "execution/executor.h"
+#include "execution/step_executor.h"
 
 using json = nlohmann::json;
 
@@ -18,6 +24,16 @@ const PatternTree::Cluster& PatternTree::APT::cluster()
 	return *(this->cluster_);
 };
 
+const std::vector<PatternTree::APT::Loop>& PatternTree::APT::loops() const
+{
+	return this->loops_;
+};
+
+const PatternTree::Arena& PatternTree::APT::arena() const
+{
+	return *(this->arena_);
+};
+
 const std::vector<std::shared_ptr<PatternTree::IData>>& PatternTree::APT::sources()
 {
 	return this->sources_;
@@ -29,8 +45,11 @@ void PatternTree::APT::optimize(PatternTree::IOptimizer& optimizer)
 	auto end_iter = this->end();
 
 	optimizer.init(begin_iter, end_iter, this->cluster());
-	for (auto iter = begin_iter; iter != end_iter; iter++)
+
+	auto loop = this->loops_.begin();
+	for (size_t index = 0; index < this->flow_.size(); index++)
 	{
+		auto iter = PatternTree::APT::Iterator(this->flow_.begin() + index);
 		optimizer.assign(iter);
 		if (!iter->complete())
 		{
@@ -38,19 +57,119 @@ void PatternTree::APT::optimize(PatternTree::IOptimizer& optimizer)
 			std::cout << "Error" << std::endl;
 			return;
 		}
+
+		while (loop != this->loops_.end() && loop->end() <= index + 1)
+		{
+			loop++;
+		}
+		if (loop == this->loops_.end() || !this->steady(*loop, index))
+		{
+			continue;
+		}
+
+		// Remaining periods repeat the mapping of the last period
+		size_t period = index + 1 - loop->period;
+		for (size_t next = index + 1; next < loop->end(); next++)
+		{
+			this->flow_[next]->map_as(*(this->flow_[next - loop->period]));
+		}
+
+		size_t trips = (loop->end() - index - 1) / loop->period;
+		optimizer.repeat(PatternTree::APT::Iterator(this->flow_.begin() + period), PatternTree::APT::Iterator(this->flow_.begin() + index + 1), trips);
+		index = loop->end() - 1;
+	}
+};
+
+void PatternTree::APT::optimize(PatternTree::IOptimizer& optimizer, const PatternTree::MappingCache& cache)
+{
+	if (cache.load(*this))
+	{
+		return;
+	}
+
+	cache.warm_start(*this);
+	this->optimize(optimizer);
+
+	bool complete = std::all_of(this->flow_.begin(), this->flow_.end(), [](const std::unique_ptr<PatternTree::Step>& step) {
+		return step->complete();
+	});
+	if (complete)
+	{
+		cache.store(*this);
 	}
 };
 
 double PatternTree::APT::evaluate(PatternTree::IPerformanceModel& model)
 {
-	for (auto iter = this->begin(); iter != this->end(); iter++)
+	auto loop = this->loops_.begin();
+	for (size_t index = 0; index < this->flow_.size(); index++)
 	{
-		model.update(*iter);
+		model.update(*(this->flow_[index]));
+
+		while (loop != this->loops_.end() && loop->end() <= index + 1)
+		{
+			loop++;
+		}
+		if (loop == this->loops_.end() || !this->steady(*loop, index))
+		{
+			continue;
+		}
+
+		// Remaining periods repeat the costs of the last period
+		std::vector<PatternTree::Step*> steps;
+		for (size_t step = index + 1 - loop->period; step <= index; step++)
+		{
+			steps.push_back(this->flow_[step].get());
+		}
+
+		size_t remaining = loop->end() - index - 1;
+		bool repeated = true;
+		for (size_t next = index + 1; next < loop->end(); next++)
+		{
+			repeated = repeated && this->flow_[next]->mapped_as(*(this->flow_[next - loop->period]));
+		}
+		if (!repeated)
+		{
+			continue;
+		}
+
+		model.repeat(steps, remaining / loop->period);
+		index = loop->end() - 1;
 	}
 
 	return model.costs();
 }
 
+void PatternTree::APT::execute(std::unordered_map<std::string, void*> buffers)
+{
+	PatternTree::StepExecutor executor;
+	this->execute(executor, buffers);
+}
+
+void PatternTree::APT::execute(PatternTree::IExecutor& executor, std::unordered_map<std::string, void*> buffers)
+{
+	if (!Kokkos::is_initialized())
+	{
+		// ERROR
+		std::cout << "Error: Kokkos is not initialized" << std::endl;
+		return;
+	}
+
+	for (auto const& source : this->sources_)
+	{
+		auto buffer = buffers.find(source->name());
+		if (buffer != buffers.end())
+		{
+			source->bind(buffer->second);
+		} else if (source->is_symbolic())
+		{
+			source->allocate();
+		}
+	}
+
+	executor.execute(this->begin(), this->end());
+}
+
 nlohmann::json PatternTree::APT::to_json()
 {
 	json report = json::object();
@@ -66,6 +185,16 @@ nlohmann::json PatternTree::APT::to_json()
 	return report;
 }
 
+bool PatternTree::APT::save(std::string path)
+{
+	return PatternTree::Archive::save(*this, path);
+};
+
+bool PatternTree::APT::load(std::string path)
+{
+	return PatternTree::Archive::load(*this, path);
+};
+
 void PatternTree::APT::summary()
 {
 	std::cout << "APT( ";
@@ -99,6 +228,18 @@ void PatternTree::APT::synchronization_efficiency_length(int length)
 	PatternTree::APT::instance->synchronization_efficiency_length_ = length;
 }
 
+void PatternTree::APT::loop_folding(bool enabled)
+{
+	PatternTree::APT::instance->loop_folding_ = enabled;
+}
+
+void PatternTree::APT::reserve(size_t patterns)
+{
+	PatternTree::APT* apt = PatternTree::APT::instance;
+	apt->flow_.reserve(apt->flow_.size() + patterns);
+	apt->arena_->reserve(patterns * PatternTree::APT::PATTERN_BYTES);
+}
+
 void PatternTree::APT::operation_interpolation_frequency(size_t frequency)
 {
 	PatternTree::APT::instance->operation_interpolation_frequency_ = frequency;
@@ -109,10 +250,166 @@ void PatternTree::APT::data_interpolation_frequency(size_t frequency)
 	PatternTree::APT::instance->data_interpolation_frequency_ = frequency;
 }
 
+std::string PatternTree::APT::identifier(const char* kind)
+{
+	return kind + std::to_string(PatternTree::APT::instance->patterns_);
+};
+
+void PatternTree::APT::insert(std::shared_ptr<PatternTree::IPattern> pattern)
+{
+	pattern->id_ = this->patterns_++;
+
+	int size = this->flow_.size();
+	int position = size;
+
+	// Latest step of the table accessing a basis view of the view
+	auto latest = [](const std::unordered_map<const PatternTree::IData*, std::vector<int>>& table, PatternTree::IView& view) {
+		int step = -1;
+		auto steps = table.find(view.data().lock().get());
+		if (steps != table.end())
+		{
+			auto const& basis_steps = steps->second;
+			PatternTree::IView::for_each_basis(view, [&](size_t id) {
+				step = std::max(step, basis_steps[id]);
+			});
+		}
+
+		return step;
+	};
+
+	if (size > 0 && this->synchronization_efficiency_)
+	{
+		int history_length = this->synchronization_efficiency_length_;
+		if (history_length < 0 || history_length > size) {
+			history_length = size;
+		}
+
+		// After the producers of the consumed views (read after write), the producers of the
+		// produced views (write after write) and the consumers of the produced views (write after read)
+		int dependency = -1;
+		for (auto const& consumed : pattern->consumes())
+		{
+			dependency = std::max(dependency, latest(this->producers_, *consumed));
+		}
+		for (auto const& produced : pattern->produces())
+		{
+			dependency = std::max(dependency, latest(this->producers_, *produced));
+			dependency = std::max(dependency, latest(this->consumers_, *produced));
+		}
+
+		position = std::max(dependency + 1, size - history_length);
+	}
+
+	auto record = [position](std::unordered_map<const PatternTree::IData*, std::vector<int>>& table, PatternTree::IView& view) {
+		auto data = view.data().lock();
+		auto& steps = table[data.get()];
+		if (steps.size() == 0)
+		{
+			steps.resize(data->basis().size(), -1);
+		}
+
+		PatternTree::IView::for_each_basis(view, [&](size_t id) {
+			steps[id] = std::max(steps[id], position);
+		});
+	};
+	for (auto const& consumed : pattern->consumes())
+	{
+		record(this->consumers_, *consumed);
+	}
+	for (auto const& produced : pattern->produces())
+	{
+		record(this->producers_, *produced);
+	}
+
+	if (position == size)
+	{
+		std::unique_ptr<PatternTree::Step> step(new PatternTree::Step(std::move(pattern), size));
+		this->flow_.push_back(std::move(step));
+	} else {
+		this->flow_[position]->add_pattern(std::move(pattern));
+	}
+}
+
+bool PatternTree::APT::steady(const PatternTree::APT::Loop& loop, size_t index) const
+{
+	// Last step of a period following the first period, before the last period
+	if (index < loop.begin + 2 * loop.period - 1 || index + 1 >= loop.end())
+	{
+		return false;
+	}
+	if ((index + 1 - loop.begin) % loop.period != 0)
+	{
+		return false;
+	}
+
+	for (size_t step = index + 1 - loop.period; step <= index; step++)
+	{
+		if (!this->flow_[step]->mapped_as(*(this->flow_[step - loop.period])))
+		{
+			return false;
+		}
+	}
+
+	return true;
+};
+
+void PatternTree::APT::fold()
+{
+	this->loops_.clear();
+
+	std::vector<uint64_t> fingerprints;
+	fingerprints.reserve(this->flow_.size());
+	for (auto const& step : this->flow_)
+	{
+		fingerprints.push_back(PatternTree::Archive::fingerprint(*step));
+	}
+
+	size_t size = fingerprints.size();
+	size_t index = 0;
+	while (index < size)
+	{
+		PatternTree::APT::Loop best = { index, 0, 0 };
+		for (size_t period = 1; period <= PatternTree::APT::MAX_PERIOD && index + period * PatternTree::APT::MIN_TRIPS <= size; period++)
+		{
+			if (fingerprints[index + period] != fingerprints[index])
+			{
+				continue;
+			}
+
+			// Periods repeat, while each step matches the step one period before
+			size_t length = period;
+			while (index + length < size && fingerprints[index + length] == fingerprints[index + length - period])
+			{
+				length++;
+			}
+
+			size_t trips = length / period;
+			if (trips >= PatternTree::APT::MIN_TRIPS && period * trips > best.period * best.trips)
+			{
+				best = { index, period, trips };
+			}
+		}
+
+		if (best.trips == 0)
+		{
+			index++;
+			continue;
+		}
+
+		this->loops_.push_back(best);
+		index = best.end();
+	}
+};
+
 std::unique_ptr<PatternTree::APT> PatternTree::APT::compile()
 {
 	std::unique_ptr<PatternTree::APT> apt(PatternTree::APT::instance);
 	PatternTree::APT::instance = 0;
 
+	if (apt->loop_folding_)
+	{
+		apt->fold();
+	}
+
 	return apt;
 };
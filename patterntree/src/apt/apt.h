@@ -7,18 +7,18 @@
 #include <string>
 #include <math.h> 
 
-#include <ctime>
-#include <unistd.h>
-
 #include <iterator>
 #include <cstddef> 
 
 #include <nlohmann/json.hpp>
 
+#include "apt/arena.h"
 #include "apt/step.h"
 #include "data/data.h"
 #include "data/view.h"
 #include "patterns/map.h"
+#include "patterns/reduce.h"
+#include "patterns/stencil.h"
 #include "patterns/pattern.h"
 #include "performance/performance_model.h"
 
@@ -26,6 +26,8 @@ namespace PatternTree {
 
 class Cluster;
 class IOptimizer;
+class MappingCache;
+class IExecutor;
 
 class APT {
 static APT* instance;
@@ -34,17 +36,82 @@ APT(std::shared_ptr<Cluster> cluster, size_t operation_interpolation_frequency,
 	operation_interpolation_frequency_(operation_interpolation_frequency),
 	data_interpolation_frequency_(data_interpolation_frequency),
 	synchronization_efficiency_(synchronization_efficiency),
-	synchronization_efficiency_length_(-1)
+	synchronization_efficiency_length_(-1),
+	loop_folding_(false),
+	patterns_(0),
+	arena_(std::make_shared<Arena>())
 {};
 
 bool synchronization_efficiency_;
 int synchronization_efficiency_length_;
+bool loop_folding_;
 size_t operation_interpolation_frequency_;
 size_t data_interpolation_frequency_;
 std::shared_ptr<Cluster> cluster_;
 std::vector<std::shared_ptr<IData>> sources_;
 std::vector<std::unique_ptr<Step>> flow_;
 
+// Number of patterns inserted, the id of the next pattern
+size_t patterns_;
+
+// Memory of the patterns, released with the last pattern
+std::shared_ptr<Arena> arena_;
+
+// Expected bytes of a pattern and its control block in the arena
+static constexpr size_t PATTERN_BYTES = 512;
+
+// Last step writing each basis view of a data, indexed by basis id
+std::unordered_map<const IData*, std::vector<int>> producers_;
+
+// Last step reading each basis view of a data, indexed by basis id
+std::unordered_map<const IData*, std::vector<int>> consumers_;
+
+void insert(std::shared_ptr<IPattern> pattern);
+
+public:
+
+	/**
+	 * Repetition of the steps [begin, begin + period) trips times, i.e. the steps
+	 * [begin, begin + period * trips) of the APT, whose patterns have equal fingerprints
+	 * and samples in each repetition. Loops are detected when compiling the APT.
+	 * The steps of all repetitions remain in the APT.
+	 */
+	struct Loop
+	{
+		size_t begin;
+		size_t period;
+		size_t trips;
+
+		size_t end() const { return begin + period * trips; };
+	};
+
+private:
+
+std::vector<Loop> loops_;
+
+// Longest period searched, repetitions needed for a loop
+static constexpr size_t MAX_PERIOD = 256;
+static constexpr size_t MIN_TRIPS = 3;
+
+/**
+ * Detects the loops of the steps greedily from the first step, preferring the period
+ * covering the most steps.
+ */
+void fold();
+
+/**
+ * Whether the step ends a period of the loop, which is mapped like the previous period.
+ * The remaining periods of the loop then repeat its mapping and costs.
+ */
+bool steady(const Loop& loop, size_t index) const;
+
+/**
+ * Deterministic identifier of the next pattern of the kind, e.g. map3 if the
+ * pattern is the fourth pattern of the APT. Identical programs yield identical
+ * identifiers across runs.
+ */
+static std::string identifier(const char* kind);
+
 public:
 	
 	struct Iterator 
@@ -79,17 +146,68 @@ public:
 
 	size_t size();
 	const Cluster& cluster();
+	const std::vector<Loop>& loops() const;
+	const Arena& arena() const;
 	const std::vector<std::shared_ptr<IData>>& sources();
 	
 	APT::Iterator begin() { return Iterator( this->flow_.begin() ); }
     APT::Iterator end()   { return Iterator( this->flow_.end() ); }
 
+	/**
+	 * Maps the steps with the optimizer. Within a loop, the optimizer maps the periods
+	 * until a period is mapped like the previous one. The remaining periods repeat its
+	 * mapping without calling the optimizer, each of their steps is split and assigned
+	 * like the step one period before.
+	 *
+	 * @param optimizer
+	 */
 	void optimize(IOptimizer& optimizer);
+
+	/**
+	 * Restores the mapping from the archive of the cache with the key of the APT. Otherwise,
+	 * the optimizer starts from the nearest archived mapping and the result is archived.
+	 *
+	 * @param optimizer
+	 * @param cache
+	 */
+	void optimize(IOptimizer& optimizer, const MappingCache& cache);
+	/**
+	 * Estimates the costs of the mapped steps. Within a loop, the periods following a
+	 * period mapped like the previous one repeat its costs.
+	 *
+	 * @param model
+	 * @return costs
+	 */
 	double evaluate(IPerformanceModel& model);
+	/**
+	 * Executes the APT. Sources are bound to the given buffers without copying.
+	 * Sources without buffer keep their previous storage or allocate owned storage.
+	 *
+	 * @param buffers
+	 */
+	void execute(std::unordered_map<std::string, void*> buffers);
+	void execute(IExecutor& executor, std::unordered_map<std::string, void*> buffers);
 
 	nlohmann::json to_json();
 	void summary();
 
+	/**
+	 * Writes the samples of the patterns and the mapping of the steps to a binary archive.
+	 *
+	 * @param path
+	 * @return true, if the archive was written
+	 */
+	bool save(std::string path);
+
+	/**
+	 * Restores the samples and the mapping from a binary archive written by the
+	 * same program for the same cluster. Replaces optimizing the APT.
+	 *
+	 * @param path
+	 * @return true, if the archive matches the APT and was restored
+	 */
+	bool load(std::string path);
+
 	static void initialize(std::shared_ptr<Cluster> cluster);
 	static void initialize(std::shared_ptr<Cluster> cluster, size_t operation_interpolation_frequency, size_t data_interpolation_frequency);
 	static void initialize(std::shared_ptr<Cluster> cluster, size_t operation_interpolation_frequency, size_t data_interpolation_frequency, bool synchronization_efficiency);
@@ -99,6 +217,23 @@ public:
 	static void synchronization_efficiency(bool enabled);
 	static void synchronization_efficiency_length(int length);
 
+	/**
+	 * Enables the detection of loops when compiling the APT. Disabled by default, since
+	 * optimizers then see the folded steps only through IOptimizer::repeat instead of assign.
+	 *
+	 * @param enabled
+	 */
+	static void loop_folding(bool enabled);
+
+	/**
+	 * Prepares the APT for the given number of patterns, e.g. before inserting the
+	 * patterns of a generated program in bulk. Patterns beyond the number are inserted
+	 * as usual.
+	 *
+	 * @param patterns
+	 */
+	static void reserve(size_t patterns);
+
 	static std::unique_ptr<APT> compile();
 
 	template<typename D>
@@ -169,20 +304,7 @@ public:
 	template<typename D, typename Functor>
 	static void map(std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> field, size_t interpolation_frequency) requires MAPFUNCTOR<Functor, D>
 	{
-    	static const char alphanum[] =
-        	"0123456789"
-        	"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        	"abcdefghijklmnopqrstuvwxyz";
-    
-    	srand( (unsigned) time(NULL) * getpid());
-
-		std::string identifier;
-    	identifier.reserve(18);
-
-    	for (int i = 0; i < 18; ++i) 
-        	identifier += alphanum[rand() % (sizeof(alphanum) - 1)];
-
-		map(identifier, std::move(functor), field, interpolation_frequency);
+		map(identifier("map"), std::move(functor), field, interpolation_frequency);
 	}
 
 	template<typename D, typename Functor>
@@ -195,40 +317,75 @@ public:
 	template<typename D, typename Functor>
 	static void map(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> field, size_t interpolation_frequency) requires MAPFUNCTOR<Functor, D>
 	{
-		auto map = Map<D>::create(identifier, std::move(functor), field, interpolation_frequency);
-		
-		if (instance->flow_.size() == 0 || !instance->synchronization_efficiency_)
-		{
-			std::unique_ptr<Step> step(new Step(std::move(map), instance->flow_.size()));
-			instance->flow_.push_back(std::move(step));
+		auto map = Map<D>::create(Arena::Allocator<Map<D>>(instance->arena_), identifier, std::move(functor), field, interpolation_frequency);
+		instance->insert(std::move(map));
+	};
+
+	template<typename D, typename Functor>
+	static void stencil(std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius) requires STENCILFUNCTOR<Functor, D>
+	{
+		size_t frequency = instance->operation_interpolation_frequency_;
+		stencil(std::move(functor), input, output, radius, frequency);
+	}
+
+	template<typename D, typename Functor>
+	static void stencil(std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius, size_t interpolation_frequency) requires STENCILFUNCTOR<Functor, D>
+	{
+		stencil(identifier("stencil"), std::move(functor), input, output, radius, interpolation_frequency);
+	}
+
+	template<typename D, typename Functor>
+	static void stencil(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius) requires STENCILFUNCTOR<Functor, D>
+	{
+		size_t frequency = instance->operation_interpolation_frequency_;
+		stencil(identifier, std::move(functor), input, output, radius, frequency);
+	}
 
+	/**
+	 * Computes each row of the output from the rows of the input within the radius.
+	 * Input and output of the same data are rejected.
+	 */
+	template<typename D, typename Functor>
+	static void stencil(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius, size_t interpolation_frequency) requires STENCILFUNCTOR<Functor, D>
+	{
+		auto stencil = Stencil<D>::create(Arena::Allocator<Stencil<D>>(instance->arena_), identifier, std::move(functor), input, output, radius, interpolation_frequency);
+		if (!stencil)
+		{
 			return;
 		}
 
-		auto prev_ = instance->flow_.end() - 1;
+		instance->insert(std::move(stencil));
+	};
 
-		int history_length = std::min(instance->synchronization_efficiency_length_, (int) instance->flow_.size());
-		if (history_length < 0) {
-			history_length = instance->flow_.size();
-		}
-		
-		for (int i = 0; i < history_length; i++) {
-			auto step_ = prev_->get();
-			if (step_->happensBefore(*map)) {
-				if (i == 0) {
-					std::unique_ptr<Step> step(new Step(std::move(map), instance->flow_.size()));
-					instance->flow_.push_back(std::move(step));
-					return;
-				} else {
-					break;
-				}
-			}
+	template<typename D, typename Functor>
+	static void reduce(std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result) requires REDUCEFUNCTOR<Functor, D>
+	{
+		size_t frequency = instance->operation_interpolation_frequency_;
+		reduce(std::move(functor), input, result, frequency);
+	}
 
-			prev_ = prev_ - 1;
-		}
+	template<typename D, typename Functor>
+	static void reduce(std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result, size_t interpolation_frequency) requires REDUCEFUNCTOR<Functor, D>
+	{
+		reduce(identifier("reduce"), std::move(functor), input, result, interpolation_frequency);
+	}
 
-		prev_ = prev_ + 1;
-		prev_->get()->add_pattern(std::move(map));
+	template<typename D, typename Functor>
+	static void reduce(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result) requires REDUCEFUNCTOR<Functor, D>
+	{
+		size_t frequency = instance->operation_interpolation_frequency_;
+		reduce(identifier, std::move(functor), input, result, frequency);
+	}
+
+	/**
+	 * Reduces the input with the associative combiner of the functor and
+	 * combines the reduced value into the first element of the result.
+	 */
+	template<typename D, typename Functor>
+	static void reduce(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result, size_t interpolation_frequency) requires REDUCEFUNCTOR<Functor, D>
+	{
+		auto reduce = Reduce<D>::create(Arena::Allocator<Reduce<D>>(instance->arena_), identifier, std::move(functor), input, result, interpolation_frequency);
+		instance->insert(std::move(reduce));
 	};
 
 };
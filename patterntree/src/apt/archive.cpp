@@ -0,0 +1,673 @@
+#include "archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <typeinfo>
+
+#include "apt/apt.h"
+#include "cluster/cluster.h"
+
+constexpr char PatternTree::Archive::MAGIC[8];
+
+void PatternTree::Archive::hash(uint64_t& key, const void* bytes, size_t size)
+{
+    const unsigned char* b = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < size; i++)
+    {
+        key ^= b[i];
+        key *= 1099511628211ULL;
+    }
+};
+
+void PatternTree::Archive::hash(uint64_t& key, const std::string& value)
+{
+    uint64_t size = value.size();
+    PatternTree::Archive::hash(key, &size, sizeof(size));
+    PatternTree::Archive::hash(key, value.data(), value.size());
+};
+
+void PatternTree::Archive::write(std::ostream& stream, const void* bytes, size_t size)
+{
+    stream.write(static_cast<const char*>(bytes), size);
+};
+
+void PatternTree::Archive::write(std::ostream& stream, uint64_t value)
+{
+    PatternTree::Archive::write(stream, &value, sizeof(value));
+};
+
+void PatternTree::Archive::write(std::ostream& stream, const std::string& value)
+{
+    PatternTree::Archive::write(stream, (uint64_t) value.size());
+    PatternTree::Archive::write(stream, value.data(), value.size());
+};
+
+bool PatternTree::Archive::read(std::istream& stream, void* bytes, size_t size)
+{
+    stream.read(static_cast<char*>(bytes), size);
+    return (size_t) stream.gcount() == size;
+};
+
+bool PatternTree::Archive::read(std::istream& stream, uint64_t& value)
+{
+    return PatternTree::Archive::read(stream, &value, sizeof(value));
+};
+
+bool PatternTree::Archive::read(std::istream& stream, std::string& value)
+{
+    uint64_t size;
+    if (!PatternTree::Archive::read(stream, size) || size > (1 << 16)) {
+        return false;
+    }
+
+    value.resize(size);
+    return PatternTree::Archive::read(stream, value.data(), size);
+};
+
+std::unordered_map<const PatternTree::IData*, uint64_t> PatternTree::Archive::sources(PatternTree::APT& apt)
+{
+    std::unordered_map<const PatternTree::IData*, uint64_t> sources;
+    for (auto const& source : apt.sources())
+    {
+        sources.insert({source.get(), sources.size()});
+    }
+
+    return sources;
+};
+
+uint64_t PatternTree::Archive::fingerprint(const PatternTree::Cluster& cluster)
+{
+    uint64_t key = FNV_OFFSET;
+    PatternTree::Archive::hash(key, cluster.topology());
+
+    std::vector<const PatternTree::Node*> nodes;
+    for (auto const& node : cluster.nodes())
+    {
+        nodes.push_back(node.second.get());
+    }
+    std::sort(nodes.begin(), nodes.end(), [](const PatternTree::Node* a, const PatternTree::Node* b) {
+        return a->index() < b->index();
+    });
+
+    for (auto const& node : nodes)
+    {
+        PatternTree::Archive::hash(key, node->identifier());
+
+        std::vector<const PatternTree::Device*> devices;
+        for (auto const& device : node->devices())
+        {
+            devices.push_back(device.second.get());
+        }
+        std::sort(devices.begin(), devices.end(), [](const PatternTree::Device* a, const PatternTree::Device* b) {
+            return a->index() < b->index();
+        });
+
+        for (auto const& device : devices)
+        {
+            double memory[4] = { device->memory_size(), device->memory_latency(), device->memory_bandwidth(), device->memory_max_bandwidth() };
+            PatternTree::Archive::hash(key, device->identifier());
+            PatternTree::Archive::hash(key, device->type());
+            PatternTree::Archive::hash(key, memory, sizeof(memory));
+
+            // Connections to the other devices of the node
+            for (auto const& other : devices)
+            {
+                double bandwidth = node->bandwidth(*device, *other);
+                double latency = node->latency(*device, *other);
+                PatternTree::Archive::hash(key, &bandwidth, sizeof(bandwidth));
+                PatternTree::Archive::hash(key, &latency, sizeof(latency));
+            }
+
+            std::map<std::string, const PatternTree::Processor*> processors;
+            for (auto const& processor : device->processors())
+            {
+                processors.insert({processor.first, processor.second.get()});
+            }
+
+            for (auto const& processor : processors)
+            {
+                int units[4] = { processor.second->cores(), processor.second->arithmetic_units(), processor.second->vector_width(), processor.second->fma() };
+                double rates[4] = { processor.second->frequency(), processor.second->cache_size(), processor.second->cache_latency(), processor.second->cache_bandwidth() };
+                PatternTree::Archive::hash(key, processor.first);
+                PatternTree::Archive::hash(key, units, sizeof(units));
+                PatternTree::Archive::hash(key, rates, sizeof(rates));
+            }
+        }
+
+        for (auto const& other : nodes)
+        {
+            double bandwidth = cluster.bandwidth(*node, *other);
+            double latency = cluster.latency(*node, *other);
+            PatternTree::Archive::hash(key, &bandwidth, sizeof(bandwidth));
+            PatternTree::Archive::hash(key, &latency, sizeof(latency));
+        }
+    }
+
+    for (auto const& link : cluster.links())
+    {
+        PatternTree::Archive::hash(key, &(link.bandwidth), sizeof(link.bandwidth));
+        PatternTree::Archive::hash(key, &(link.latency), sizeof(link.latency));
+    }
+
+    return key;
+};
+
+uint64_t PatternTree::Archive::fingerprint(const PatternTree::IPattern& pattern)
+{
+    uint64_t key = FNV_OFFSET;
+
+    int width = pattern.width();
+    uint64_t frequency = pattern.interpolation_frequency();
+    PatternTree::Archive::hash(key, typeid(pattern).name());
+    PatternTree::Archive::hash(key, pattern.functor().name());
+    PatternTree::Archive::hash(key, &width, sizeof(width));
+    PatternTree::Archive::hash(key, &frequency, sizeof(frequency));
+
+    auto hash_flow = [&key](const PatternTree::Dataflow& flow) {
+        uint64_t size = flow.size();
+        PatternTree::Archive::hash(key, &size, sizeof(size));
+
+        for (auto const& view : flow)
+        {
+            auto data = view->data().lock();
+            PatternTree::Archive::hash(key, data->name());
+            for (int dim : data->shape())
+            {
+                PatternTree::Archive::hash(key, &dim, sizeof(dim));
+            }
+            for (int begin : view->begins())
+            {
+                PatternTree::Archive::hash(key, &begin, sizeof(begin));
+            }
+            for (int end : view->ends())
+            {
+                PatternTree::Archive::hash(key, &end, sizeof(end));
+            }
+        }
+    };
+    hash_flow(pattern.consumes());
+    hash_flow(pattern.produces());
+
+    return key;
+};
+
+uint64_t PatternTree::Archive::fingerprint(PatternTree::Step& step)
+{
+    uint64_t key = FNV_OFFSET;
+
+    uint64_t size = step.size();
+    PatternTree::Archive::hash(key, &size, sizeof(size));
+
+    for (auto pattern = step.begin(); pattern != step.end(); ++pattern)
+    {
+        uint64_t fingerprint = PatternTree::Archive::fingerprint(*pattern);
+        PatternTree::Archive::hash(key, &fingerprint, sizeof(fingerprint));
+
+        // Functors of the same type may differ in their costs
+        for (auto const& sample : pattern->samples())
+        {
+            uint64_t values[4] = { (uint64_t) sample.first, sample.second.flops, sample.second.bytes_read, sample.second.bytes_written };
+            PatternTree::Archive::hash(key, values, sizeof(values));
+        }
+    }
+
+    return key;
+};
+
+uint64_t PatternTree::Archive::key(PatternTree::APT& apt)
+{
+    uint64_t key = FNV_OFFSET;
+
+    uint64_t cluster = PatternTree::Archive::fingerprint(apt.cluster());
+    PatternTree::Archive::hash(key, &cluster, sizeof(cluster));
+
+    // Sources and their basis views, which follow the interpolation frequency of the data
+    for (auto const& source : apt.sources())
+    {
+        uint64_t basis = source->basis().size();
+        PatternTree::Archive::hash(key, source->name());
+        PatternTree::Archive::hash(key, &basis, sizeof(basis));
+        for (int dim : source->shape())
+        {
+            PatternTree::Archive::hash(key, &dim, sizeof(dim));
+        }
+    }
+
+    // Steps and their patterns
+    for (auto step = apt.begin(); step != apt.end(); ++step)
+    {
+        uint64_t size = step->size();
+        PatternTree::Archive::hash(key, &size, sizeof(size));
+
+        for (auto pattern = step->begin(); pattern != step->end(); ++pattern)
+        {
+            uint64_t fingerprint = PatternTree::Archive::fingerprint(*pattern);
+            PatternTree::Archive::hash(key, &fingerprint, sizeof(fingerprint));
+            PatternTree::Archive::hash_samples(key, *pattern);
+        }
+    }
+
+    return key;
+};
+
+void PatternTree::Archive::hash_samples(uint64_t& key, const PatternTree::IPattern& pattern)
+{
+    // Equidistant indices and the last index, as touched by the patterns when they are created
+    size_t width = pattern.width();
+    size_t interpolation_width = std::max(width / std::max(pattern.interpolation_frequency(), (size_t) 1), (size_t) 1);
+    auto const& samples = pattern.samples();
+    auto hash_sample = [&](size_t index) {
+        auto sample = samples.find(index);
+        if (sample == samples.end()) {
+            return;
+        }
+
+        uint64_t values[4] = { (uint64_t) sample->first, sample->second.flops, sample->second.bytes_read, sample->second.bytes_written };
+        PatternTree::Archive::hash(key, values, sizeof(values));
+    };
+
+    for (size_t i = 0; i < width; i = i + interpolation_width)
+    {
+        hash_sample(i);
+    }
+    if (width > 0 && (width - 1) % interpolation_width != 0) {
+        hash_sample(width - 1);
+    }
+};
+
+bool PatternTree::Archive::save(PatternTree::APT& apt, std::string path)
+{
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        // ERROR
+        std::cout << "Error: Cannot write archive " << path << std::endl;
+        return false;
+    }
+
+    PatternTree::Archive::write(stream, MAGIC, sizeof(MAGIC));
+    PatternTree::Archive::write(stream, &VERSION, sizeof(VERSION));
+    PatternTree::Archive::write(stream, PatternTree::Archive::key(apt));
+    PatternTree::Archive::write(stream, PatternTree::Archive::fingerprint(apt.cluster()));
+
+    // Teams of all steps, in the order of their first assignment
+    std::vector<std::shared_ptr<PatternTree::Team>> teams;
+    std::unordered_map<const PatternTree::Team*, uint64_t> team_indices;
+    for (auto step = apt.begin(); step != apt.end(); ++step)
+    {
+        for (auto const& split : step->splits())
+        {
+            auto team = step->assigned(split.get());
+            if (team.has_value() && team_indices.find(team.value().get()) == team_indices.end())
+            {
+                team_indices.insert({team.value().get(), teams.size()});
+                teams.push_back(team.value());
+            }
+        }
+    }
+
+    PatternTree::Archive::write(stream, (uint64_t) teams.size());
+    for (auto const& team : teams)
+    {
+        auto const& processor = team->processor();
+        auto const& device = processor.device();
+
+        std::string processor_identifier;
+        for (auto const& entry : device.processors())
+        {
+            if (entry.second.get() == &processor) {
+                processor_identifier = entry.first;
+            }
+        }
+
+        PatternTree::Archive::write(stream, device.node().identifier());
+        PatternTree::Archive::write(stream, device.identifier());
+        PatternTree::Archive::write(stream, processor_identifier);
+        PatternTree::Archive::write(stream, (uint64_t) team->cores());
+    }
+
+    auto sources = PatternTree::Archive::sources(apt);
+    PatternTree::Archive::write(stream, (uint64_t) apt.size());
+    for (auto step = apt.begin(); step != apt.end(); ++step)
+    {
+        PatternTree::Archive::write(stream, (uint64_t) step->size());
+        for (auto pattern = step->begin(); pattern != step->end(); ++pattern)
+        {
+            PatternTree::Archive::write(stream, PatternTree::Archive::fingerprint(*pattern));
+            PatternTree::Archive::write(stream, (uint64_t) pattern->width());
+
+            auto const& samples = pattern->samples();
+            PatternTree::Archive::write(stream, (uint64_t) samples.size());
+            for (auto const& sample : samples)
+            {
+                PatternTree::Archive::write(stream, (uint64_t) sample.first);
+                PatternTree::Archive::write(stream, (uint64_t) sample.second.flops);
+                PatternTree::Archive::write(stream, (uint64_t) sample.second.bytes_read);
+                PatternTree::Archive::write(stream, (uint64_t) sample.second.bytes_written);
+
+                PatternTree::Archive::write(stream, (uint64_t) sample.second.subviews.size());
+                for (auto const& subview : sample.second.subviews)
+                {
+                    PatternTree::Archive::write(stream, sources.at(subview.first));
+                    PatternTree::Archive::write(stream, (uint64_t) subview.second->begins().size());
+                    for (int begin : subview.second->begins())
+                    {
+                        PatternTree::Archive::write(stream, (uint64_t) begin);
+                    }
+                    for (int end : subview.second->ends())
+                    {
+                        PatternTree::Archive::write(stream, (uint64_t) end);
+                    }
+                }
+            }
+
+            auto splits = step->splits(*pattern);
+            std::sort(splits.begin(), splits.end(), [](const std::reference_wrapper<const PatternTree::PatternSplit>& a, const std::reference_wrapper<const PatternTree::PatternSplit>& b) {
+                return a.get().begin() < b.get().begin();
+            });
+
+            PatternTree::Archive::write(stream, (uint64_t) splits.size());
+            for (auto const& split : splits)
+            {
+                auto team = step->assigned(split.get());
+                PatternTree::Archive::write(stream, (uint64_t) split.get().begin());
+                PatternTree::Archive::write(stream, (uint64_t) split.get().end());
+                PatternTree::Archive::write(stream, team.has_value() ? team_indices.at(team.value().get()) : UNASSIGNED);
+            }
+        }
+    }
+
+    return (bool) stream;
+};
+
+bool PatternTree::Archive::header(std::istream& stream, uint64_t& key, uint64_t& cluster)
+{
+    char magic[sizeof(MAGIC)];
+    uint32_t version;
+    return PatternTree::Archive::read(stream, magic, sizeof(magic)) && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0
+        && PatternTree::Archive::read(stream, &version, sizeof(version)) && version == VERSION
+        && PatternTree::Archive::read(stream, key)
+        && PatternTree::Archive::read(stream, cluster);
+};
+
+bool PatternTree::Archive::read(std::istream& stream, PatternTree::APT& apt, Contents& contents)
+{
+    uint64_t teams_size;
+    if (!PatternTree::Archive::read(stream, teams_size)) { return false; }
+
+    const PatternTree::Cluster& cluster = apt.cluster();
+    for (uint64_t t = 0; t < teams_size; t++)
+    {
+        std::string node_identifier, device_identifier, processor_identifier;
+        uint64_t cores;
+        if (!PatternTree::Archive::read(stream, node_identifier) || !PatternTree::Archive::read(stream, device_identifier)
+            || !PatternTree::Archive::read(stream, processor_identifier) || !PatternTree::Archive::read(stream, cores))
+        {
+            return false;
+        }
+
+        auto node = cluster.nodes().find(node_identifier);
+        if (node == cluster.nodes().end()) { return false; }
+        auto device = node->second->devices().find(device_identifier);
+        if (device == node->second->devices().end()) { return false; }
+        auto processor = device->second->processors().find(processor_identifier);
+        if (processor == device->second->processors().end()) { return false; }
+
+        contents.teams.push_back(std::shared_ptr<PatternTree::Team>(new PatternTree::Team(processor->second, cores)));
+    }
+
+    uint64_t steps_size;
+    if (!PatternTree::Archive::read(stream, steps_size)) { return false; }
+
+    for (uint64_t s = 0; s < steps_size; s++)
+    {
+        uint64_t patterns_size;
+        if (!PatternTree::Archive::read(stream, patterns_size)) { return false; }
+
+        std::vector<Pattern> patterns;
+        for (uint64_t p = 0; p < patterns_size; p++)
+        {
+            Pattern pattern;
+
+            uint64_t samples_size;
+            if (!PatternTree::Archive::read(stream, pattern.fingerprint) || !PatternTree::Archive::read(stream, pattern.width)
+                || !PatternTree::Archive::read(stream, samples_size))
+            {
+                return false;
+            }
+
+            for (uint64_t i = 0; i < samples_size; i++)
+            {
+                uint64_t index, flops, bytes_read, bytes_written, subviews_size;
+                if (!PatternTree::Archive::read(stream, index) || !PatternTree::Archive::read(stream, flops)
+                    || !PatternTree::Archive::read(stream, bytes_read) || !PatternTree::Archive::read(stream, bytes_written)
+                    || !PatternTree::Archive::read(stream, subviews_size) || index >= pattern.width)
+                {
+                    return false;
+                }
+
+                PatternTree::PatternIndexInfo info;
+                info.index = index;
+                info.flops = flops;
+                info.bytes_read = bytes_read;
+                info.bytes_written = bytes_written;
+                pattern.samples.insert({(int) index, info});
+
+                std::vector<Subview>& subviews = pattern.subviews[index];
+                for (uint64_t v = 0; v < subviews_size; v++)
+                {
+                    Subview subview;
+                    uint64_t dims;
+                    if (!PatternTree::Archive::read(stream, subview.source) || !PatternTree::Archive::read(stream, dims) || dims > 2) { return false; }
+
+                    for (uint64_t d = 0; d < 2 * dims; d++)
+                    {
+                        uint64_t value;
+                        if (!PatternTree::Archive::read(stream, value)) { return false; }
+                        (d < dims ? subview.begins : subview.ends).push_back(value);
+                    }
+
+                    subviews.push_back(subview);
+                }
+            }
+
+            uint64_t splits_size;
+            if (!PatternTree::Archive::read(stream, splits_size) || splits_size == 0 || splits_size > pattern.width) { return false; }
+
+            uint64_t end = 0;
+            for (uint64_t i = 0; i < splits_size; i++)
+            {
+                Split split;
+                if (!PatternTree::Archive::read(stream, split.begin) || !PatternTree::Archive::read(stream, split.end)
+                    || !PatternTree::Archive::read(stream, split.team))
+                {
+                    return false;
+                }
+
+                // Splits cover the pattern without gaps
+                if (split.begin != end || split.end <= split.begin || split.end > pattern.width) { return false; }
+                if (split.team != UNASSIGNED && split.team >= contents.teams.size()) { return false; }
+
+                end = split.end;
+                pattern.splits.push_back(split);
+            }
+            if (end != pattern.width) { return false; }
+
+            patterns.push_back(pattern);
+        }
+
+        contents.steps.push_back(patterns);
+    }
+
+    return true;
+};
+
+std::vector<PatternTree::Archive::Match> PatternTree::Archive::match(PatternTree::APT& apt, const Contents& contents)
+{
+    // Archived patterns by fingerprint, in the order of the archive
+    std::unordered_map<uint64_t, std::vector<const Pattern*>> archived;
+    for (auto step = contents.steps.rbegin(); step != contents.steps.rend(); ++step)
+    {
+        for (auto pattern = step->rbegin(); pattern != step->rend(); ++pattern)
+        {
+            bool assigned = std::all_of(pattern->splits.begin(), pattern->splits.end(), [](const Split& split) {
+                return split.team != UNASSIGNED;
+            });
+            if (assigned) {
+                archived[pattern->fingerprint].push_back(&(*pattern));
+            }
+        }
+    }
+
+    std::vector<Match> matches;
+    for (auto step = apt.begin(); step != apt.end(); ++step)
+    {
+        for (auto pattern = step->begin(); pattern != step->end(); ++pattern)
+        {
+            auto candidates = archived.find(PatternTree::Archive::fingerprint(*pattern));
+            if (candidates == archived.end() || candidates->second.empty()) {
+                continue;
+            }
+
+            matches.push_back({ &(*step), &(*pattern), candidates->second.back() });
+            candidates->second.pop_back();
+        }
+    }
+
+    return matches;
+};
+
+void PatternTree::Archive::restore(PatternTree::Step& step, PatternTree::IPattern& pattern, const Pattern& archived, const Contents& contents)
+{
+    std::vector<size_t> sizes;
+    for (auto const& split : archived.splits)
+    {
+        sizes.push_back(split.end - split.begin);
+    }
+
+    auto splits = step.split(pattern, sizes);
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        if (archived.splits[i].team != UNASSIGNED) {
+            step.assign(splits[i].get(), contents.teams[archived.splits[i].team]);
+        }
+    }
+};
+
+bool PatternTree::Archive::load(PatternTree::APT& apt, std::string path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        // ERROR
+        std::cout << "Error: Cannot read archive " << path << std::endl;
+        return false;
+    }
+
+    uint64_t key, cluster;
+    if (!PatternTree::Archive::header(stream, key, cluster)) {
+        // ERROR
+        std::cout << "Error: Invalid archive " << path << std::endl;
+        return false;
+    }
+
+    if (key != PatternTree::Archive::key(apt)) {
+        // ERROR
+        std::cout << "Error: Archive " << path << " does not match the APT and its cluster" << std::endl;
+        return false;
+    }
+
+    // Reads and validates the archive completely before modifying the APT
+    Contents contents;
+    bool valid = PatternTree::Archive::read(stream, apt, contents) && contents.steps.size() == apt.size();
+
+    auto const& sources = apt.sources();
+    size_t s = 0;
+    for (auto step = apt.begin(); valid && step != apt.end(); ++step, ++s)
+    {
+        valid = contents.steps[s].size() == step->size();
+        for (auto const& pattern : contents.steps[s])
+        {
+            for (auto const& sample : pattern.subviews)
+            {
+                for (auto const& subview : sample.second)
+                {
+                    valid = valid && subview.source < sources.size() && !sources[subview.source]->basis().empty()
+                        && subview.begins.size() == sources[subview.source]->shape().size();
+                }
+            }
+        }
+    }
+
+    if (!valid) {
+        // ERROR
+        std::cout << "Error: Corrupted archive " << path << std::endl;
+        return false;
+    }
+
+    // Samples first, such that the splits take their subviews from the samples
+    s = 0;
+    for (auto step = apt.begin(); step != apt.end(); ++step, ++s)
+    {
+        size_t p = 0;
+        for (auto pattern = step->begin(); pattern != step->end(); ++pattern, ++p)
+        {
+            Pattern& archived = contents.steps[s][p];
+            for (auto& sample : archived.samples)
+            {
+                for (auto const& subview : archived.subviews[sample.first])
+                {
+                    auto const& data = sources[subview.source];
+                    sample.second.subviews[data.get()] = PatternTree::IView::region(*(data->basis().front()), subview.begins, subview.ends);
+                }
+            }
+
+            // Samples touched since the APT was compiled take precedence over the archived samples
+            std::map<int, PatternTree::PatternIndexInfo> samples = archived.samples;
+            for (auto const& sample : pattern->samples())
+            {
+                samples[sample.first] = sample.second;
+            }
+
+            pattern->restore(std::move(samples));
+            PatternTree::Archive::restore(*step, *pattern, archived, contents);
+        }
+    }
+
+    return true;
+};
+
+size_t PatternTree::Archive::matches(PatternTree::APT& apt, std::string path)
+{
+    std::ifstream stream(path, std::ios::binary);
+
+    uint64_t key, cluster;
+    Contents contents;
+    if (!stream || !PatternTree::Archive::header(stream, key, cluster) || cluster != PatternTree::Archive::fingerprint(apt.cluster())
+        || !PatternTree::Archive::read(stream, apt, contents))
+    {
+        return 0;
+    }
+
+    return PatternTree::Archive::match(apt, contents).size();
+};
+
+size_t PatternTree::Archive::warm_start(PatternTree::APT& apt, std::string path)
+{
+    std::ifstream stream(path, std::ios::binary);
+
+    uint64_t key, cluster;
+    Contents contents;
+    if (!stream || !PatternTree::Archive::header(stream, key, cluster) || cluster != PatternTree::Archive::fingerprint(apt.cluster())
+        || !PatternTree::Archive::read(stream, apt, contents))
+    {
+        return 0;
+    }
+
+    auto matches = PatternTree::Archive::match(apt, contents);
+    for (auto const& match : matches)
+    {
+        PatternTree::Archive::restore(*(match.step), *(match.pattern), *(match.archived), contents);
+    }
+
+    return matches.size();
+};
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "patterns/pattern.h"
+#include "cluster/team.h"
+
+namespace PatternTree
+{
+
+class APT;
+class Cluster;
+class Step;
+
+/**
+ * Binary archive of a compiled APT. The archive stores the samples of the patterns,
+ * i.e. the FLOPS, bytes and subviews of their touched indices, and the splits of each
+ * step with the teams assigned to them. It is keyed by a hash of the structure of the
+ * APT and the description of the cluster.
+ *
+ * Loading the archive into an APT compiled by the same program on the same cluster
+ * restores its samples and mapping, such that the APT can be executed or evaluated
+ * without optimizing it again. Values are stored in the byte order of the host.
+ */
+class Archive {
+
+static constexpr char MAGIC[8] = { 'P', 'T', 'A', 'R', 'C', 'H', 'I', 'V' };
+static constexpr uint32_t VERSION = 2;
+static constexpr uint64_t UNASSIGNED = (uint64_t) -1;
+static constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+
+struct Split {
+    uint64_t begin;
+    uint64_t end;
+    uint64_t team;
+};
+
+struct Subview {
+    uint64_t source;
+    std::vector<int> begins;
+    std::vector<int> ends;
+};
+
+struct Pattern {
+    uint64_t fingerprint;
+    uint64_t width;
+    std::map<int, PatternIndexInfo> samples;
+    std::map<int, std::vector<Subview>> subviews;
+    std::vector<Split> splits;
+};
+
+struct Contents {
+    std::vector<std::shared_ptr<Team>> teams;
+    std::vector<std::vector<Pattern>> steps;
+};
+
+// Patterns of the APT and the archived patterns of the same fingerprint
+struct Match {
+    Step* step;
+    IPattern* pattern;
+    const Pattern* archived;
+};
+
+// FNV-1a hash of the bytes
+static void hash(uint64_t& key, const void* bytes, size_t size);
+static void hash(uint64_t& key, const std::string& value);
+
+static void write(std::ostream& stream, const void* bytes, size_t size);
+static void write(std::ostream& stream, uint64_t value);
+static void write(std::ostream& stream, const std::string& value);
+static bool read(std::istream& stream, void* bytes, size_t size);
+static bool read(std::istream& stream, uint64_t& value);
+static bool read(std::istream& stream, std::string& value);
+
+// Hashes the samples of the indices touched when the pattern was created, which refinement does not change
+static void hash_samples(uint64_t& key, const IPattern& pattern);
+
+static std::unordered_map<const IData*, uint64_t> sources(APT& apt);
+
+// Reads the key and the fingerprint of the cluster of the archive
+static bool header(std::istream& stream, uint64_t& key, uint64_t& cluster);
+
+// Reads the teams, resolved on the cluster of the APT, and the steps following the header
+static bool read(std::istream& stream, APT& apt, Contents& contents);
+
+// Patterns of the APT with an archived pattern of the same fingerprint, whose splits are all assigned
+static std::vector<Match> match(APT& apt, const Contents& contents);
+
+// Splits the pattern and assigns the splits as archived
+static void restore(Step& step, IPattern& pattern, const Pattern& archived, const Contents& contents);
+
+public:
+
+    /**
+     * Hash of the structure of the APT and its cluster. Covers the cluster, the sources
+     * with their basis views and the fingerprints of the patterns of each step. Functors of
+     * the same type may differ in their costs, so the samples of the indices touched when
+     * the patterns were created are covered as well.
+     *
+     * @param apt
+     * @return key
+     */
+    static uint64_t key(APT& apt);
+
+    /**
+     * Hash of the nodes, devices, processors and links of the cluster, including every
+     * parameter of their costs: the memories of the devices, the cores, vector units,
+     * frequencies and caches of the processors and the connections within and between nodes.
+     *
+     * @param cluster
+     * @return fingerprint
+     */
+    static uint64_t fingerprint(const Cluster& cluster);
+
+    /**
+     * Hash of the type, functor type, width and interpolation frequency of the pattern
+     * and the names, shapes and regions of its consumed and produced views.
+     * Identifiers of patterns are not covered.
+     *
+     * @param pattern
+     * @return fingerprint
+     */
+    static uint64_t fingerprint(const IPattern& pattern);
+
+    /**
+     * Hash of the fingerprints and samples of the patterns of the step in their order.
+     * Steps of equal fingerprints have equal costs under equal mappings.
+     *
+     * @param step
+     * @return fingerprint
+     */
+    static uint64_t fingerprint(Step& step);
+
+    /**
+     * Writes the samples and the mapping of the APT to the file.
+     *
+     * @param apt
+     * @param path
+     * @return true, if the archive was written
+     */
+    static bool save(APT& apt, std::string path);
+
+    /**
+     * Restores the samples and the mapping of the APT from the file. The APT is left
+     * unchanged, if the archive does not match the key of the APT. Samples touched in the
+     * APT are kept, archived samples only add indices not touched yet.
+     *
+     * @param apt
+     * @param path
+     * @return true, if the archive was restored
+     */
+    static bool load(APT& apt, std::string path);
+
+    /**
+     * Number of patterns of the APT, whose fingerprint matches a mapped pattern of
+     * the archive for the same cluster.
+     *
+     * @param apt
+     * @param path
+     * @return matching patterns
+     */
+    static size_t matches(APT& apt, std::string path);
+
+    /**
+     * Splits and assigns the matching patterns of the APT as in the archive, such that an
+     * optimizer can start from the archived mapping. Samples of the APT are left unchanged.
+     *
+     * @param apt
+     * @param path
+     * @return restored patterns
+     */
+    static size_t warm_start(APT& apt, std::string path);
+};
+
+}
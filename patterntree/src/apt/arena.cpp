@@ -0,0 +1,55 @@
+#include "arena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+PatternTree::Arena::Arena()
+: 	chunks_(),
+	chunk_size_(PatternTree::Arena::INITIAL_CHUNK_SIZE),
+	current_(nullptr),
+	remaining_(0),
+	allocated_(0)
+{};
+
+void* PatternTree::Arena::allocate(size_t bytes, size_t alignment)
+{
+	size_t padding = (alignment - ((uintptr_t) this->current_ % alignment)) % alignment;
+	if (this->current_ == nullptr || padding + bytes > this->remaining_)
+	{
+		this->reserve(bytes + alignment);
+		padding = (alignment - ((uintptr_t) this->current_ % alignment)) % alignment;
+	}
+
+	void* memory = this->current_ + padding;
+	this->current_ += padding + bytes;
+	this->remaining_ -= padding + bytes;
+	this->allocated_ += padding + bytes;
+
+	return memory;
+};
+
+void PatternTree::Arena::reserve(size_t bytes)
+{
+	if (this->current_ != nullptr && bytes <= this->remaining_)
+	{
+		return;
+	}
+
+	// Chunks double in size up to the maximum, larger requests get a chunk of their own
+	size_t size = std::max(this->chunk_size_, bytes);
+	this->chunk_size_ = std::min(this->chunk_size_ * 2, PatternTree::Arena::MAX_CHUNK_SIZE);
+
+	this->chunks_.emplace_back(new char[size]);
+	this->current_ = this->chunks_.back().get();
+	this->remaining_ = size;
+};
+
+size_t PatternTree::Arena::allocated() const
+{
+	return this->allocated_;
+};
+
+size_t PatternTree::Arena::chunks() const
+{
+	return this->chunks_.size();
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace PatternTree
+{
+
+/**
+ * Bump allocator for the objects of an APT, which live as long as the APT itself,
+ * e.g. its patterns. Allocations are carved from chunks of growing size and are
+ * never freed individually. The chunks are released at once with the arena.
+ *
+ * Objects are allocated through Arena::Allocator, which shares the ownership of the
+ * arena, such that the arena outlives each object allocated from it. The arena is
+ * not thread-safe, like the construction of an APT.
+ */
+class Arena {
+
+// Chunks are large enough to be mapped apart from the heap, which they would fragment otherwise
+static constexpr size_t INITIAL_CHUNK_SIZE = 1024 * 1024;
+static constexpr size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024;
+
+std::vector<std::unique_ptr<char[]>> chunks_;
+size_t chunk_size_;
+char* current_;
+size_t remaining_;
+size_t allocated_;
+
+public:
+
+    /**
+     * Allocator of the standard library, which allocates from the arena.
+     * Deallocation is a no-op.
+     */
+    template<typename T>
+    struct Allocator
+    {
+        using value_type = T;
+
+        std::shared_ptr<Arena> arena;
+
+        Allocator(std::shared_ptr<Arena> arena)
+        : arena(arena)
+        {};
+
+        template<typename U>
+        Allocator(const Allocator<U>& other)
+        : arena(other.arena)
+        {};
+
+        T* allocate(size_t n)
+        {
+            return static_cast<T*>(this->arena->allocate(n * sizeof(T), alignof(T)));
+        };
+
+        void deallocate(T*, size_t) {};
+
+        template<typename U>
+        friend bool operator== (const Allocator<T>& a, const Allocator<U>& b) { return a.arena == b.arena; };
+
+        template<typename U>
+        friend bool operator!= (const Allocator<T>& a, const Allocator<U>& b) { return a.arena != b.arena; };
+    };
+
+    Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Allocates uninitialized memory from the current chunk. Starts a new chunk,
+     * if the current chunk is exhausted.
+     *
+     * @param bytes
+     * @param alignment power of two
+     * @return memory
+     */
+    void* allocate(size_t bytes, size_t alignment);
+
+    /**
+     * Starts a chunk of at least the given bytes, if the current chunk is smaller.
+     * Reserving the expected size of an APT avoids growing the arena chunk by chunk.
+     *
+     * @param bytes
+     */
+    void reserve(size_t bytes);
+
+    /**
+     * Bytes allocated from the arena, including padding for alignment.
+     */
+    size_t allocated() const;
+
+    /**
+     * Number of chunks of the arena.
+     */
+    size_t chunks() const;
+
+    /**
+     * Constructs the object in the arena. The control block of the shared pointer
+     * is allocated next to the object.
+     *
+     * @param arena
+     * @param args arguments of the constructor
+     * @return object
+     */
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> make_shared(std::shared_ptr<Arena> arena, Args&&... args)
+    {
+        return std::allocate_shared<T>(Arena::Allocator<T>(arena), std::forward<Args>(args)...);
+    };
+};
+
+}
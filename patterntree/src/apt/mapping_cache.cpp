@@ -0,0 +1,78 @@
+#include "mapping_cache.h"
+
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "apt/apt.h"
+#include "apt/archive.h"
+
+PatternTree::MappingCache::MappingCache(std::string directory)
+: directory_(directory)
+{};
+
+const std::string& PatternTree::MappingCache::directory() const
+{
+    return this->directory_;
+};
+
+std::string PatternTree::MappingCache::path(uint64_t key) const
+{
+    std::stringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0') << key << ".apt";
+
+    return (std::filesystem::path(this->directory_) / name.str()).string();
+};
+
+bool PatternTree::MappingCache::load(PatternTree::APT& apt) const
+{
+    std::string path = this->path(PatternTree::Archive::key(apt));
+    if (!std::filesystem::exists(path)) {
+        return false;
+    }
+
+    return PatternTree::Archive::load(apt, path);
+};
+
+size_t PatternTree::MappingCache::warm_start(PatternTree::APT& apt) const
+{
+    std::error_code error;
+    if (!std::filesystem::is_directory(this->directory_, error)) {
+        return 0;
+    }
+
+    // Nearest archive by the number of matching patterns
+    size_t max_matches = 0;
+    std::string nearest;
+    for (auto const& entry : std::filesystem::directory_iterator(this->directory_, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".apt") { continue; }
+
+        size_t matches = PatternTree::Archive::matches(apt, entry.path().string());
+        if (matches > max_matches || (matches == max_matches && matches > 0 && entry.path().string() < nearest))
+        {
+            max_matches = matches;
+            nearest = entry.path().string();
+        }
+    }
+
+    if (max_matches == 0) {
+        return 0;
+    }
+
+    return PatternTree::Archive::warm_start(apt, nearest);
+};
+
+bool PatternTree::MappingCache::store(PatternTree::APT& apt) const
+{
+    std::error_code error;
+    std::filesystem::create_directories(this->directory_, error);
+    if (error) {
+        // ERROR
+        std::cout << "Error: Cannot create mapping cache " << this->directory_ << std::endl;
+        return false;
+    }
+
+    return PatternTree::Archive::save(apt, this->path(PatternTree::Archive::key(apt)));
+};
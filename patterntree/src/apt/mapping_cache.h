@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace PatternTree
+{
+
+class APT;
+
+/**
+ * Directory of archived mappings of optimized APTs, one archive per key of an APT
+ * and its cluster. An APT with the key of an archive is restored from it. Otherwise,
+ * the archive for the same cluster sharing the most pattern fingerprints with the APT
+ * is the nearest mapping, which the optimizer starts from.
+ */
+class MappingCache {
+
+std::string directory_;
+
+public:
+    MappingCache(std::string directory);
+
+    const std::string& directory() const;
+
+    /**
+     * Path of the archive of the key in the directory.
+     *
+     * @param key
+     * @return path
+     */
+    std::string path(uint64_t key) const;
+
+    /**
+     * Restores the APT from the archive of its key.
+     *
+     * @param apt
+     * @return true, if the archive exists and was restored
+     */
+    bool load(APT& apt) const;
+
+    /**
+     * Splits and assigns the patterns of the APT as in the nearest archive.
+     *
+     * @param apt
+     * @return restored patterns
+     */
+    size_t warm_start(APT& apt) const;
+
+    /**
+     * Archives the mapping of the APT under its key, creating the directory if needed.
+     *
+     * @param apt
+     * @return true, if the archive was written
+     */
+    bool store(APT& apt) const;
+};
+
+}
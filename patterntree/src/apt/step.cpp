@@ -1,5 +1,9 @@
 #include "step.h"
 
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
 using json = nlohmann::json;
 
 PatternTree::Step::Step(std::vector<std::unique_ptr<PatternTree::IPattern>>& patterns, size_t index)
@@ -11,19 +15,18 @@ PatternTree::Step::Step(std::vector<std::unique_ptr<PatternTree::IPattern>>& pat
     }
 };
 
-PatternTree::Step::Step(std::unique_ptr<PatternTree::IPattern> pattern, size_t index)
+PatternTree::Step::Step(std::shared_ptr<PatternTree::IPattern> pattern, size_t index)
 : index_(index), assignment_(), reverse_assigment_()
 {
     PatternTree::Step::add_pattern(std::move(pattern));
 };
 
-void PatternTree::Step::add_pattern(std::unique_ptr<IPattern> pattern)
+void PatternTree::Step::add_pattern(std::shared_ptr<IPattern> pattern)
 {
-    std::shared_ptr<PatternTree::IPattern> p = std::move(pattern);
-    this->patterns_.push_back(p);
+    this->patterns_.push_back(pattern);
 
-    std::unique_ptr<PatternTree::PatternSplit> split(new PatternTree::PatternSplit(p));
-    this->splits_.insert({p.get(), std::move(split)});
+    std::unique_ptr<PatternTree::PatternSplit> split(new PatternTree::PatternSplit(pattern));
+    this->splits_.insert({pattern.get(), std::move(split)});
 }
 
 json PatternTree::Step::to_json()
@@ -37,17 +40,18 @@ json PatternTree::Step::to_json()
     if (this->complete()) {
         for (auto const& pattern : this->patterns_) {
             json pattern_assignment = json::object();
+            pattern_assignment["id"] = pattern->id();
             pattern_assignment["pattern"] = pattern->identifier();
 
+            // Splits in index order, such that identical mappings yield identical reports
             json splits_assignment = json::array();
-            auto splits = this->splits_.equal_range(pattern.get());
-            for (auto& it = splits.first; it != splits.second; ++it) {
+            for (auto const& split : this->ordered_splits(*pattern)) {
                 json split_assignment = json::object();
 
-                split_assignment["split_begin"] = it->second->begin();
-                split_assignment["split_end"] = it->second->end();
+                split_assignment["split_begin"] = split.get().begin();
+                split_assignment["split_end"] = split.get().end();
 
-                auto team = this->assigned(*(it->second)).value();
+                auto team = this->assigned(split.get()).value();
                 split_assignment["cores"] = team->cores();
                 split_assignment["processor"] = team->processor().to_json();
 
@@ -181,6 +185,60 @@ std::vector<std::reference_wrapper<const PatternTree::PatternSplit>> PatternTree
     return this->split(pattern, sizes);
 };
 
+std::vector<std::reference_wrapper<const PatternTree::PatternSplit>> PatternTree::Step::split_balanced(const PatternTree::IPattern& pattern, const std::vector<double>& weights)
+{
+    size_t n = weights.size();
+    if (n == 0 || n > (size_t) pattern.width() || std::any_of(weights.begin(), weights.end(), [](double w) { return w <= 0.0; })) {
+        // ERROR
+        std::cout << "Error: Cannot balance pattern " << pattern.id() << " (" << pattern.identifier() << ") over " << n << " splits" << std::endl;
+        return {};
+    }
+
+    // Cumulative FLOPS of the indices before the boundary, the index space without FLOPS
+    size_t width = pattern.width();
+    double total = pattern.range_flops(0, width);
+    auto cumulative = [&](size_t boundary) -> double {
+        return total > 0.0 ? pattern.range_flops(0, boundary) : (double) boundary;
+    };
+    if (total <= 0.0) {
+        total = width;
+    }
+
+    double sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double target = 0.0;
+
+    std::vector<size_t> sizes;
+    size_t begin = 0;
+    for (size_t i = 0; i < n - 1; i++)
+    {
+        target += total * weights[i] / sum;
+
+        // First boundary reaching the target, leaving an index for each remaining split
+        size_t lb = begin + 1;
+        size_t ub = width - (n - 1 - i);
+        while (lb < ub)
+        {
+            size_t mid = lb + (ub - lb) / 2;
+            if (cumulative(mid) < target) {
+                lb = mid + 1;
+            } else {
+                ub = mid;
+            }
+        }
+
+        size_t boundary = lb;
+        if (boundary > begin + 1 && target - cumulative(boundary - 1) < cumulative(boundary) - target) {
+            boundary--;
+        }
+
+        sizes.push_back(boundary - begin);
+        begin = boundary;
+    }
+    sizes.push_back(width - begin);
+
+    return this->split(pattern, sizes);
+};
+
 void PatternTree::Step::assign(const PatternTree::IPattern& pattern, std::shared_ptr<Team> team)
 {
     auto range = this->splits_.equal_range(&pattern);
@@ -193,8 +251,6 @@ void PatternTree::Step::assign(const PatternTree::PatternSplit& split, std::shar
 {
     auto it = this->assignment_.find(&split);
     if (it != this->assignment_.end()) {
-        this->assignment_.erase(it);
-
         auto reverse_range = this->reverse_assigment_.equal_range(it->second.get());
         for (auto reverse_it = reverse_range.first; reverse_it != reverse_range.second; reverse_it++) {
             if (reverse_it->second == it->first) {
@@ -202,6 +258,8 @@ void PatternTree::Step::assign(const PatternTree::PatternSplit& split, std::shar
                 break;
             }
         }
+
+        this->assignment_.erase(it);
     }
     this->assignment_.insert({&split, team});
     this->reverse_assigment_.insert({team.get(), &split});
@@ -223,7 +281,6 @@ void PatternTree::Step::free(const PatternTree::PatternSplit& split)
         return;
     }
 
-    this->assignment_.erase(iter);
     auto range = this->reverse_assigment_.equal_range(iter->second.get());
     for (auto it = range.first; it != range.second; ++it) {
         if (it->second == &split)
@@ -232,6 +289,7 @@ void PatternTree::Step::free(const PatternTree::PatternSplit& split)
             break;
         }
     }
+    this->assignment_.erase(iter);
 };
 
 std::vector<std::reference_wrapper<const PatternTree::PatternSplit>> PatternTree::Step::assigned(const Team& team) const
@@ -255,6 +313,75 @@ std::optional<std::shared_ptr<PatternTree::Team>> PatternTree::Step::assigned(co
     return std::optional<std::shared_ptr<PatternTree::Team>>{ iter->second };
 };
 
+std::vector<std::reference_wrapper<const PatternTree::PatternSplit>> PatternTree::Step::ordered_splits(const PatternTree::IPattern& pattern) const
+{
+    auto splits = this->splits(pattern);
+    std::sort(splits.begin(), splits.end(), [](const PatternTree::PatternSplit& a, const PatternTree::PatternSplit& b) {
+        return a.begin() < b.begin();
+    });
+
+    return splits;
+};
+
+bool PatternTree::Step::mapped_as(const PatternTree::Step& other) const
+{
+    if (this->patterns_.size() != other.patterns_.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < this->patterns_.size(); i++)
+    {
+        auto splits = this->ordered_splits(*(this->patterns_[i]));
+        auto other_splits = other.ordered_splits(*(other.patterns_[i]));
+        if (splits.size() != other_splits.size())
+        {
+            return false;
+        }
+
+        for (size_t j = 0; j < splits.size(); j++)
+        {
+            const PatternTree::PatternSplit& split = splits[j];
+            const PatternTree::PatternSplit& other_split = other_splits[j];
+            if (split.begin() != other_split.begin() || split.end() != other_split.end())
+            {
+                return false;
+            }
+
+            if (this->assigned(split) != other.assigned(other_split))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+};
+
+void PatternTree::Step::map_as(const PatternTree::Step& other)
+{
+    for (size_t i = 0; i < this->patterns_.size() && i < other.patterns_.size(); i++)
+    {
+        auto other_splits = other.ordered_splits(*(other.patterns_[i]));
+
+        std::vector<size_t> sizes;
+        for (const PatternTree::PatternSplit& split : other_splits)
+        {
+            sizes.push_back(split.end() - split.begin());
+        }
+
+        auto splits = this->split(*(this->patterns_[i]), sizes);
+        for (size_t j = 0; j < splits.size(); j++)
+        {
+            auto team = other.assigned(other_splits[j]);
+            if (team.has_value())
+            {
+                this->assign(splits[j].get(), team.value());
+            }
+        }
+    }
+};
+
 bool PatternTree::Step::happensBefore(const PatternTree::IPattern& pattern)
 {
     for (auto it = this->begin(); it != this->end(); it++)
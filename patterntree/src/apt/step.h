@@ -26,13 +26,16 @@ std::unordered_multimap<const IPattern*, std::unique_ptr<PatternSplit>> splits_;
 std::unordered_map<const PatternSplit*, std::shared_ptr<Team>> assignment_;
 std::unordered_multimap<const Team*, const PatternSplit*> reverse_assigment_;
 
-void add_pattern(std::unique_ptr<IPattern> patterns);
+void add_pattern(std::shared_ptr<IPattern> pattern);
+
+// Splits of the pattern ordered by their begin
+std::vector<std::reference_wrapper<const PatternSplit>> ordered_splits(const IPattern& pattern) const;
 
 public:
     friend class APT;
 
     Step(std::vector<std::unique_ptr<IPattern>>& patterns, size_t index);
-    Step(std::unique_ptr<IPattern> patterns, size_t index);
+    Step(std::shared_ptr<IPattern> pattern, size_t index);
 
     struct Iterator 
 	{
@@ -80,6 +83,19 @@ public:
 	std::vector<std::reference_wrapper<const PatternSplit>> split(const IPattern& pattern, std::vector<size_t> sizes);
 	std::vector<std::reference_wrapper<const PatternSplit>> split(const IPattern& pattern, size_t n);
 
+	/**
+	 * Splits the pattern into one split per weight, where the FLOPS of each split are
+	 * proportional to its weight, e.g. the throughput of the team executing it.
+	 * The boundaries are placed on the cumulative FLOPS of the pattern, such that
+	 * teams of the given throughputs finish their splits at the same time.
+	 * Each split covers at least one index.
+	 *
+	 * @param pattern
+	 * @param weights positive weights of the splits
+	 * @return splits in the order of the weights
+	 */
+	std::vector<std::reference_wrapper<const PatternSplit>> split_balanced(const IPattern& pattern, const std::vector<double>& weights);
+
     void assign(const IPattern& pattern, std::shared_ptr<Team> team);
     void assign(const PatternSplit& split, std::shared_ptr<Team> team);
     void free(const PatternSplit& split);
@@ -88,6 +104,23 @@ public:
     std::vector<std::reference_wrapper<const PatternSplit>> assigned(const Team& team) const;
     std::optional<std::shared_ptr<Team>> assigned(const PatternSplit& split) const;
 
+    /**
+     * Whether the patterns at the same positions of both steps are split at the same
+     * indices and their splits are assigned to the same teams.
+     *
+     * @param other step of the same size
+     * @return true, if the mappings are equal
+     */
+    bool mapped_as(const Step& other) const;
+
+    /**
+     * Splits and assigns the patterns like the patterns at the same positions of the
+     * other step, e.g. the step of the previous iteration of a loop.
+     *
+     * @param other step of the same size and widths of patterns
+     */
+    void map_as(const Step& other);
+
     bool happensBefore(const IPattern& pattern);
 };
 
@@ -1,5 +1,9 @@
 #include "cluster.h"
 
+#include <algorithm>
+#include <limits>
+#include <map>
+
 PatternTree::Cluster::Cluster(std::string topology,
     std::vector<std::string> ordered_ids,
     std::vector<double> bandwidth_matrix,
@@ -11,7 +15,12 @@ PatternTree::Cluster::Cluster(std::string topology,
     bandwidth_matrix_(bandwidth_matrix),
     latency_matrix_(latency_matrix),
     nodes_(nodes),
-    addresses_(addresses)
+    addresses_(addresses),
+    devices_(0),
+    device_bandwidth_matrix_(),
+    device_latency_matrix_(),
+    links_(),
+    routes_()
 {};
 
 std::string PatternTree::Cluster::topology() const
@@ -26,44 +35,298 @@ const std::unordered_map<std::string, std::shared_ptr<PatternTree::Node>>& Patte
 
 double PatternTree::Cluster::bandwidth(const PatternTree::Node& from, const PatternTree::Node& to) const
 {
-    int pos_from = -1;
-    int pos_to = -1;
-    for (int i = 0; i < this->ordered_ids_.size(); i++) {
-        std::string id = this->ordered_ids_[i];
-        if (id == from.identifier()) {
-            pos_from = i;
+    size_t index = from.index() * this->ordered_ids_.size() + to.index();
+    return this->bandwidth_matrix_.at(index);
+};
+
+double PatternTree::Cluster::latency(const PatternTree::Node& from, const PatternTree::Node& to) const
+{
+    size_t index = from.index() * this->ordered_ids_.size() + to.index();
+    return this->latency_matrix_.at(index);
+};
+
+
+const std::vector<PatternTree::Cluster::Link>& PatternTree::Cluster::links() const
+{
+    return this->links_;
+};
+
+const std::vector<size_t>& PatternTree::Cluster::route(const PatternTree::Node& from, const PatternTree::Node& to) const
+{
+    size_t index = from.index() * this->ordered_ids_.size() + to.index();
+    return this->routes_.at(index);
+};
+
+double PatternTree::Cluster::bandwidth(const PatternTree::Processor& from, const PatternTree::Processor& to) const
+{
+    size_t index = from.device().cluster_index() * this->devices_ + to.device().cluster_index();
+    return this->device_bandwidth_matrix_.at(index);
+};
+
+double PatternTree::Cluster::latency(const PatternTree::Processor& from, const PatternTree::Processor& to) const
+{
+    size_t index = from.device().cluster_index() * this->devices_ + to.device().cluster_index();
+    return this->device_latency_matrix_.at(index);
+};
+
+void PatternTree::Cluster::index()
+{
+    std::vector<const PatternTree::Device*> devices;
+    for (size_t i = 0; i < this->ordered_ids_.size(); i++)
+    {
+        auto node = this->nodes_.at(this->ordered_ids_[i]);
+        node->index_ = i;
+
+        std::vector<std::shared_ptr<PatternTree::Device>> node_devices(node->devices().size());
+        for (auto const& device : node->devices())
+        {
+            node_devices[device.second->index()] = device.second;
         }
-        if (id == to.identifier()) {
-            pos_to = i;
+
+        for (auto const& device : node_devices)
+        {
+            device->cluster_index_ = devices.size();
+            devices.push_back(device.get());
         }
+    }
 
-        if (pos_to != -1 && pos_from != -1) {
-            break;
+    // Connections between all devices, within a node or across the cluster
+    this->devices_ = devices.size();
+    this->device_bandwidth_matrix_.resize(this->devices_ * this->devices_);
+    this->device_latency_matrix_.resize(this->devices_ * this->devices_);
+    for (auto const& from : devices)
+    {
+        for (auto const& to : devices)
+        {
+            size_t index = from->cluster_index() * this->devices_ + to->cluster_index();
+            const PatternTree::Node& from_node = from->node();
+            const PatternTree::Node& to_node = to->node();
+            if (&from_node == &to_node) {
+                this->device_bandwidth_matrix_[index] = from_node.bandwidth(*from, *to);
+                this->device_latency_matrix_[index] = from_node.latency(*from, *to);
+            } else {
+                this->device_bandwidth_matrix_[index] = this->bandwidth(from_node, to_node);
+                this->device_latency_matrix_[index] = this->latency(from_node, to_node);
+            }
         }
     }
+};
 
-    int index = pos_from * this->ordered_ids_.size() + pos_to;
-    return this->bandwidth_matrix_.at(index);
+bool PatternTree::Cluster::connect(const json& cluster_json)
+{
+    size_t n = this->ordered_ids_.size();
+    this->links_.clear();
+    this->routes_.assign(n * n, {});
+
+    if (this->topology_ == "fully") {
+        if (this->bandwidth_matrix_.size() != n * n || this->latency_matrix_.size() != n * n) {
+            // ERROR
+            std::cout << "Error: Connectivity of fully connected cluster does not match its " << n << " nodes" << std::endl;
+            return false;
+        }
+
+        this->connect_fully();
+        return true;
+    }
+
+    double bandwidth = cluster_json.value("link-bandwidth", 0.0);
+    double latency = cluster_json.value("link-latency", 0.0);
+    if (bandwidth <= 0.0) {
+        // ERROR
+        std::cout << "Error: Topology " << this->topology_ << " requires a positive link-bandwidth" << std::endl;
+        return false;
+    }
+
+    if (this->topology_ == "tree" || this->topology_ == "fat-tree") {
+        size_t arity = cluster_json.value("arity", 2);
+        if (arity < 2) {
+            // ERROR
+            std::cout << "Error: Topology " << this->topology_ << " requires an arity of at least 2" << std::endl;
+            return false;
+        }
+
+        this->connect_tree(arity, bandwidth, latency, this->topology_ == "fat-tree");
+    } else if (this->topology_ == "torus") {
+        std::vector<int> dimensions = cluster_json.value("dimensions", std::vector<int>({ (int) n }));
+        if (!this->connect_torus(dimensions, bandwidth, latency)) {
+            return false;
+        }
+    } else {
+        // ERROR
+        std::cout << "Error: Unknown topology " << this->topology_ << std::endl;
+        return false;
+    }
+
+    // Connectivity of the routes
+    this->bandwidth_matrix_.assign(n * n, 0.0);
+    this->latency_matrix_.assign(n * n, 0.0);
+    for (size_t i = 0; i < n * n; i++)
+    {
+        if (this->routes_[i].empty()) {
+            continue;
+        }
+
+        double route_bandwidth = std::numeric_limits<double>::max();
+        double route_latency = 0.0;
+        for (auto const& link : this->routes_[i])
+        {
+            route_bandwidth = std::min(route_bandwidth, this->links_[link].bandwidth);
+            route_latency += this->links_[link].latency;
+        }
+
+        this->bandwidth_matrix_[i] = route_bandwidth;
+        this->latency_matrix_[i] = route_latency;
+    }
+
+    return true;
 };
 
-double PatternTree::Cluster::latency(const PatternTree::Node& from, const PatternTree::Node& to) const
+void PatternTree::Cluster::connect_fully()
 {
-    int pos_from = -1;
-    int pos_to = -1;
-    for (int i = 0; i < this->ordered_ids_.size(); i++) {
-        std::string id = this->ordered_ids_[i];
-        if (id == from.identifier()) {
-            pos_from = i;
+    size_t n = this->ordered_ids_.size();
+    for (size_t from = 0; from < n; from++)
+    {
+        for (size_t to = 0; to < n; to++)
+        {
+            if (from == to) { continue; }
+
+            size_t index = from * n + to;
+            this->routes_[index].push_back(this->links_.size());
+            this->links_.push_back({ this->bandwidth_matrix_[index], this->latency_matrix_[index] });
         }
-        if (id == to.identifier()) {
-            pos_to = i;
+    }
+};
+
+void PatternTree::Cluster::connect_tree(size_t arity, double bandwidth, double latency, bool fat)
+{
+    size_t n = this->ordered_ids_.size();
+
+    // Vertices are the nodes followed by the switches, level by level
+    std::vector<size_t> parent(n, 0);
+    std::vector<size_t> up(n, 0);
+    std::vector<size_t> down(n, 0);
+
+    std::vector<size_t> level_vertices(n);
+    for (size_t i = 0; i < n; i++) { level_vertices[i] = i; }
+
+    double level_bandwidth = bandwidth;
+    while (level_vertices.size() > 1)
+    {
+        std::vector<size_t> switches;
+        for (size_t i = 0; i < level_vertices.size(); i += arity)
+        {
+            size_t vertex = parent.size();
+            parent.push_back(vertex);
+            up.push_back(0);
+            down.push_back(0);
+            switches.push_back(vertex);
+
+            for (size_t j = i; j < std::min(i + arity, level_vertices.size()); j++)
+            {
+                size_t child = level_vertices[j];
+                parent[child] = vertex;
+                up[child] = this->links_.size();
+                this->links_.push_back({ level_bandwidth, latency });
+                down[child] = this->links_.size();
+                this->links_.push_back({ level_bandwidth, latency });
+            }
         }
 
-        if (pos_to != -1 && pos_from != -1) {
-            break;
+        level_vertices = switches;
+        if (fat) {
+            level_bandwidth *= arity;
         }
     }
 
-    int index = pos_from * this->ordered_ids_.size() + pos_to;
-    return this->latency_matrix_.at(index);
+    // Up to the lowest common switch and down again, all nodes are on the same level
+    for (size_t from = 0; from < n; from++)
+    {
+        for (size_t to = 0; to < n; to++)
+        {
+            if (from == to) { continue; }
+
+            std::vector<size_t>& route = this->routes_[from * n + to];
+            std::vector<size_t> downwards;
+            size_t a = from;
+            size_t b = to;
+            while (a != b)
+            {
+                route.push_back(up[a]);
+                downwards.push_back(down[b]);
+                a = parent[a];
+                b = parent[b];
+            }
+            route.insert(route.end(), downwards.rbegin(), downwards.rend());
+        }
+    }
+};
+
+bool PatternTree::Cluster::connect_torus(std::vector<int> dimensions, double bandwidth, double latency)
+{
+    size_t n = this->ordered_ids_.size();
+
+    size_t size = 1;
+    for (auto const& dimension : dimensions)
+    {
+        size *= std::max(dimension, 0);
+    }
+    if (size != n) {
+        // ERROR
+        std::cout << "Error: Dimensions of torus do not match its " << n << " nodes" << std::endl;
+        return false;
+    }
+
+    // Nodes are placed in row-major order
+    std::vector<size_t> strides(dimensions.size(), 1);
+    for (int k = (int) dimensions.size() - 2; k >= 0; k--)
+    {
+        strides[k] = strides[k + 1] * dimensions[k + 1];
+    }
+
+    // Links between the neighbours in each dimension, in both directions
+    std::map<std::pair<size_t, size_t>, size_t> links;
+    auto link = [&](size_t from, size_t to) -> size_t {
+        auto it = links.find({from, to});
+        if (it != links.end()) {
+            return it->second;
+        }
+
+        size_t id = this->links_.size();
+        this->links_.push_back({ bandwidth, latency });
+        links.insert({{from, to}, id});
+        return id;
+    };
+
+    auto coordinate = [&](size_t node, size_t k) -> int {
+        return (node / strides[k]) % dimensions[k];
+    };
+
+    for (size_t from = 0; from < n; from++)
+    {
+        for (size_t to = 0; to < n; to++)
+        {
+            if (from == to) { continue; }
+
+            // Dimension-ordered, along the shorter direction of each ring
+            std::vector<size_t>& route = this->routes_[from * n + to];
+            size_t current = from;
+            for (size_t k = 0; k < dimensions.size(); k++)
+            {
+                int d = dimensions[k];
+                int delta = ((coordinate(to, k) - coordinate(current, k)) % d + d) % d;
+                int step = delta <= d - delta ? 1 : d - 1;
+                int steps = delta <= d - delta ? delta : d - delta;
+
+                for (int i = 0; i < steps; i++)
+                {
+                    int c = coordinate(current, k);
+                    size_t next = current - c * strides[k] + ((c + step) % d) * strides[k];
+                    route.push_back(link(current, next));
+                    current = next;
+                }
+            }
+        }
+    }
+
+    return true;
 };
@@ -17,6 +17,17 @@ using json = nlohmann::json;
 namespace PatternTree
 {
 class Cluster {
+public:
+
+    /**
+     * Directed link of the network between the nodes of the cluster.
+     */
+    struct Link {
+        double bandwidth;
+        double latency;
+    };
+
+private:
 std::string topology_;
 std::vector<std::string> ordered_ids_;
 std::vector<double> bandwidth_matrix_;
@@ -24,6 +35,24 @@ std::vector<double> latency_matrix_;
 std::unordered_map<std::string, std::shared_ptr<Node>> nodes_;
 std::unordered_map<std::string, std::string> addresses_;
 
+// Connections between the devices of the cluster, by their cluster index
+size_t devices_;
+std::vector<double> device_bandwidth_matrix_;
+std::vector<double> device_latency_matrix_;
+
+// Links of the network and the routes between the nodes, by the index of the source and target node
+std::vector<Link> links_;
+std::vector<std::vector<size_t>> routes_;
+
+// Assigns dense indices to nodes and devices and fills the device matrices
+void index();
+
+// Builds the links and routes of the topology and derives the connectivity matrices of routed topologies
+bool connect(const json& cluster_json);
+void connect_fully();
+void connect_tree(size_t arity, double bandwidth, double latency, bool fat);
+bool connect_torus(std::vector<int> dimensions, double bandwidth, double latency);
+
 public:
     Cluster(std::string topology,
         std::vector<std::string> ordered_ids,
@@ -39,6 +68,48 @@ public:
     double bandwidth(const Node& from, const Node& to) const;
     double latency(const Node& from, const Node& to) const;
 
+    /**
+     * Links of the network of the cluster. For the fully connected topology, each
+     * pair of nodes has its own link. Tree and fat-tree topologies connect the nodes
+     * as leaves of a tree of switches with the given arity, where the links of a
+     * fat-tree multiply their bandwidth by the arity on each level. Torus topologies
+     * connect the nodes as a grid of the given dimensions with wrap-around links.
+     * 
+     * @return links
+     */
+    const std::vector<Link>& links() const;
+
+    /**
+     * Links on the route between the nodes, empty for the same node. Routes lead
+     * through the lowest common switch of trees and are dimension-ordered on tori.
+     * The bandwidth of a route is the minimum and its latency the sum of its links.
+     * 
+     * @param from
+     * @param to
+     * @return indices of the links
+     */
+    const std::vector<size_t>& route(const Node& from, const Node& to) const;
+
+    /**
+     * Bandwidth of the connection between the devices of the processors, through
+     * their node or across the cluster. Looked up in constant time.
+     * 
+     * @param from
+     * @param to
+     * @return bandwidth in MB/s
+     */
+    double bandwidth(const Processor& from, const Processor& to) const;
+
+    /**
+     * Latency of the connection between the devices of the processors, through
+     * their node or across the cluster. Looked up in constant time.
+     * 
+     * @param from
+     * @param to
+     * @return latency in nanoseconds
+     */
+    double latency(const Processor& from, const Processor& to) const;
+
     static std::shared_ptr<Cluster> parse(std::string path)
     {
         std::ifstream cluster_file(path);
@@ -81,7 +152,7 @@ public:
         }
 
         std::shared_ptr<Cluster> cluster(new Cluster(
-            cluster_json["topology"],
+            cluster_json.value("topology", "fully"),
             ordered_ids,
             bandwidth_matrix,
             latency_matrix,
@@ -94,6 +165,11 @@ public:
             entry.second->identifier_ = entry.first;
             entry.second->cluster_ = cluster;
         }
+        if (!cluster->connect(cluster_json)) {
+            return nullptr;
+        }
+        cluster->index();
+
         return cluster;
     };
 
@@ -1,7 +1,7 @@
 #include "device.h"
 
 PatternTree::Device::Device(std::string type, double memory_size, double memory_latency, double memory_bandwidth, double memory_max_bandwidth, std::unordered_map<std::string, std::shared_ptr<PatternTree::Processor>> processors)
-: identifier_(""), type_(type), memory_size_(memory_size), memory_latency_(memory_latency), memory_bandwidth_(memory_bandwidth), memory_max_bandwidth_(memory_max_bandwidth), processors_(processors)
+: identifier_(""), index_(-1), cluster_index_(-1), type_(type), memory_size_(memory_size), memory_latency_(memory_latency), memory_bandwidth_(memory_bandwidth), memory_max_bandwidth_(memory_max_bandwidth), processors_(processors)
 {};
 
 std::string PatternTree::Device::identifier() const
@@ -9,6 +9,16 @@ std::string PatternTree::Device::identifier() const
     return this->identifier_;
 };
 
+int PatternTree::Device::index() const
+{
+    return this->index_;
+};
+
+int PatternTree::Device::cluster_index() const
+{
+    return this->cluster_index_;
+};
+
 std::string PatternTree::Device::type() const
 {
     return this->type_;
@@ -19,6 +19,8 @@ class Node;
 
 class Device {
 std::string identifier_;
+int index_;
+int cluster_index_;
 std::string type_;
 double memory_size_;
 double memory_latency_;
@@ -31,10 +33,26 @@ std::unordered_map<std::string, std::shared_ptr<Processor>> processors_;
 
 public:
     friend class Node;
+    friend class Cluster;
 
     Device(std::string type, double memory_size, double memory_latency, double memory_bandwidth, double memory_max_bandwidth, std::unordered_map<std::string, std::shared_ptr<Processor>> processors);
 
     std::string identifier() const;
+
+    /**
+     * Dense index of the device in the order of the devices of its node.
+     * 
+     * @return index
+     */
+    int index() const;
+
+    /**
+     * Dense index of the device among all devices of the cluster.
+     * 
+     * @return index
+     */
+    int cluster_index() const;
+
     std::string type() const;
     double memory_size() const;
     double memory_latency() const;
@@ -6,7 +6,7 @@ PatternTree::Node::Node(std::string type,
     std::vector<double> latency_matrix,
     std::unordered_map<std::string, std::shared_ptr<Device>> devices
 )
-: identifier_(""), type_(type), ordered_ids_(ordered_ids), bandwidth_matrix_(bandwidth_matrix), latency_matrix_(latency_matrix), devices_(devices)
+: identifier_(""), index_(-1), type_(type), ordered_ids_(ordered_ids), bandwidth_matrix_(bandwidth_matrix), latency_matrix_(latency_matrix), devices_(devices)
 {};
 
 std::string PatternTree::Node::identifier() const
@@ -14,6 +14,11 @@ std::string PatternTree::Node::identifier() const
     return this->identifier_;;
 };
 
+int PatternTree::Node::index() const
+{
+    return this->index_;
+};
+
 std::string PatternTree::Node::type() const
 {
     return this->type_;
@@ -31,45 +36,13 @@ const PatternTree::Cluster& PatternTree::Node::cluster() const
 
 double PatternTree::Node::bandwidth(const PatternTree::Device& from, const PatternTree::Device& to) const
 {
-    int pos_from = -1;
-    int pos_to = -1;
-    for (int i = 0; i < this->ordered_ids_.size(); i++) {
-        std::string id = this->ordered_ids_[i];
-        if (id == from.identifier()) {
-            pos_from = i;
-        }
-        if (id == to.identifier()) {
-            pos_to = i;
-        }
-
-        if (pos_to != -1 && pos_from != -1) {
-            break;
-        }
-    }
-
-    int index = pos_from * this->ordered_ids_.size() + pos_to;
+    size_t index = from.index() * this->ordered_ids_.size() + to.index();
     return this->bandwidth_matrix_.at(index);
 };
 
 double PatternTree::Node::latency(const PatternTree::Device& from, const PatternTree::Device& to) const
 {
-    int pos_from = -1;
-    int pos_to = -1;
-    for (int i = 0; i < this->ordered_ids_.size(); i++) {
-        std::string id = this->ordered_ids_[i];
-        if (id == from.identifier()) {
-            pos_from = i;
-        }
-        if (id == to.identifier()) {
-            pos_to = i;
-        }
-
-        if (pos_to != -1 && pos_from != -1) {
-            break;
-        }
-    }
-
-    int index = pos_from * this->ordered_ids_.size() + pos_to;
+    size_t index = from.index() * this->ordered_ids_.size() + to.index();
     return this->latency_matrix_.at(index);
 };
 
@@ -125,5 +98,9 @@ std::shared_ptr<PatternTree::Node> PatternTree::Node::parse(std::string path)
         device.second->identifier_ = device.first;
         device.second->node_ = node;
     }
+    for (size_t i = 0; i < ordered_ids.size(); i++)
+    {
+        devices[ordered_ids[i]]->index_ = i;
+    }
     return node;
 };
\ No newline at end of file
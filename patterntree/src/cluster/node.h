@@ -18,6 +18,7 @@ namespace PatternTree
 class Cluster;
 class Node {
 std::string identifier_;
+int index_;
 std::string type_;
 std::vector<std::string> ordered_ids_;
 std::vector<double> bandwidth_matrix_;
@@ -40,6 +41,14 @@ public:
     const Cluster& cluster() const;
     std::string type() const;
     std::string identifier() const;
+
+    /**
+     * Dense index of the node in the order of the nodes of its cluster.
+     * 
+     * @return index
+     */
+    int index() const;
+
     const std::unordered_map<std::string, std::shared_ptr<Device>>& devices() const;
 
     double bandwidth(const Device& from, const Device& to) const;
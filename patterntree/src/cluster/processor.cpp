@@ -4,10 +4,12 @@
 #include "cluster/node.h"
 
 PatternTree::Processor::Processor(int cores, int arithmetic_units, double frequency,
-    double cache_size, double cache_latency, double cache_bandwidth)
+    double cache_size, double cache_latency, double cache_bandwidth, int vector_width, bool fma)
 {
     this->cores_ = cores;
     this->arithmetic_units_ = arithmetic_units;
+    this->vector_width_ = vector_width;
+    this->fma_ = fma;
     this->frequency_ = frequency;
 
     this->cache_size_ = cache_size;
@@ -25,6 +27,16 @@ int PatternTree::Processor::arithmetic_units() const
     return this->arithmetic_units_;
 };
 
+int PatternTree::Processor::vector_width() const
+{
+    return this->vector_width_;
+};
+
+bool PatternTree::Processor::fma() const
+{
+    return this->fma_;
+};
+
 double PatternTree::Processor::frequency() const
 {
     return this->frequency_;
@@ -55,6 +67,9 @@ json PatternTree::Processor::to_json() const
     json processor;
     processor["frequency"] = this->frequency_;
     processor["cores"] = this->cores_;
+    processor["arithmetic-units"] = this->arithmetic_units_;
+    processor["vector-width"] = this->vector_width_;
+    processor["fma"] = this->fma_;
     
     auto device = this->device_.lock();
     processor["device"] = device->identifier();
@@ -63,12 +78,29 @@ json PatternTree::Processor::to_json() const
     return processor;
 }
 
+int PatternTree::Processor::vector_width(std::string vectorization)
+{
+    if (vectorization == "avx512") {
+        return 8;
+    } else if (vectorization == "avx2" || vectorization == "avx") {
+        return 4;
+    } else if (vectorization.rfind("sse", 0) == 0 || vectorization == "neon") {
+        return 2;
+    }
+
+    return 1;
+};
+
 std::shared_ptr<PatternTree::Processor> PatternTree::Processor::parse(std::string path)
 {
     std::ifstream processor_file(path);
     json processor_json;
     processor_file >> processor_json;
 
+    // FMA is implied by the extensions, which introduced it, if not given explicitly
+    std::string vectorization = processor_json.value("vectorization", "");
+    bool fma = processor_json.value("fma", vectorization == "avx2" || vectorization == "avx512");
+
     auto highest_cache_json = processor_json["caches"].back();
     std::shared_ptr<PatternTree::Processor> processor(new PatternTree::Processor(
         processor_json["cores"],
@@ -76,7 +108,9 @@ std::shared_ptr<PatternTree::Processor> PatternTree::Processor::parse(std::strin
         processor_json["frequency"],
         highest_cache_json["size"],
         highest_cache_json["latency"],
-        highest_cache_json["bandwidth"]
+        highest_cache_json["bandwidth"],
+        PatternTree::Processor::vector_width(vectorization),
+        fma
     ));
 
     return processor;
@@ -18,6 +18,8 @@ class Device;
 class Processor {
 int cores_;
 int arithmetic_units_;
+int vector_width_;
+bool fma_;
 double frequency_;
 
 double cache_size_;
@@ -29,7 +31,7 @@ std::weak_ptr<Device> device_;
 public:
     friend class Device;
 
-    Processor(int cores, int arithmetic_units, double frequency, double cache_size, double cache_latency, double cache_bandwidth);
+    Processor(int cores, int arithmetic_units, double frequency, double cache_size, double cache_latency, double cache_bandwidth, int vector_width = 1, bool fma = false);
     
     /**
      * Number of cores.
@@ -45,6 +47,21 @@ public:
      */
     int arithmetic_units() const;
 
+    /**
+     * Number of double precision lanes of the vector units.
+     * 
+     * @return vector width
+     */
+    int vector_width() const;
+
+    /**
+     * Whether the arithmetic units fuse a multiplication and an addition
+     * into a single instruction.
+     * 
+     * @return fma
+     */
+    bool fma() const;
+
     /**
      * Clock frequency.
      * 
@@ -88,6 +105,15 @@ public:
      */
     json to_json() const;
 
+    /**
+     * Number of double precision lanes of an instruction set extension,
+     * e.g. 8 for avx512. Unknown or empty extensions are scalar.
+     * 
+     * @param vectorization
+     * @return vector width
+     */
+    static int vector_width(std::string vectorization);
+
     static std::shared_ptr<Processor> parse(std::string path);
 
 };
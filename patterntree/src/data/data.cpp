@@ -1,10 +1,19 @@
 #include "data.h"
 
+#include <bit>
+#include <iostream>
+
 #include "data/view.h"
 
-PatternTree::IData::IData(std::string name, int dim0, int dim1)
-: name_(name), symbolic_(true)
+PatternTree::IData::IData(std::string name, int dim0, int dim1, size_t element_bytes)
+: name_(name), symbolic_(true), layout_(Layout::RIGHT), alignment_(64), element_bytes_(element_bytes)
 {
+	// Elements, which do not divide a cache line, are aligned to their size only
+	if (this->alignment_ % element_bytes != 0)
+	{
+		this->alignment_ = element_bytes;
+	}
+
 	std::vector<int> shape;
 	shape.push_back(dim0);
 	if (dim1 > 0)
@@ -20,7 +29,7 @@ std::string PatternTree::IData::name() const
 	return this->name_;
 };
 
-std::vector<int> PatternTree::IData::shape() const
+const std::vector<int>& PatternTree::IData::shape() const
 {
 	return this->shape_;
 };
@@ -29,3 +38,31 @@ bool PatternTree::IData::is_symbolic() const
 {
 	return this->symbolic_;
 };
+
+PatternTree::IData::Layout PatternTree::IData::layout() const
+{
+	return this->layout_;
+};
+
+size_t PatternTree::IData::alignment() const
+{
+	return this->alignment_;
+};
+
+void PatternTree::IData::set_layout(PatternTree::IData::Layout layout)
+{
+	this->layout_ = layout;
+};
+
+bool PatternTree::IData::set_alignment(size_t alignment)
+{
+	if (!std::has_single_bit(alignment) || alignment % this->element_bytes_ != 0)
+	{
+		// ERROR
+		std::cout << "Error: Alignment " << alignment << " is not a power of two and a multiple of " << this->element_bytes_ << " bytes" << std::endl;
+		return false;
+	}
+
+	this->alignment_ = alignment;
+	return true;
+};
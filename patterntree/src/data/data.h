@@ -7,6 +7,8 @@
 #include <algorithm>
 #include <math.h>
 
+#include <Kokkos_Core.hpp>
+
 #include "data/data_concepts.h"
 
 namespace PatternTree
@@ -19,8 +21,17 @@ class IData {
 std::string name_;
 std::vector<int> shape_;
 
+public:
+	enum Layout {
+		RIGHT,
+		LEFT
+	};
+
 protected:
 	bool symbolic_;
+	Layout layout_;
+	size_t alignment_;
+	size_t element_bytes_;
 
 	std::vector<size_t> split_size_;
 	std::vector<std::shared_ptr<IView>> basis_;
@@ -28,36 +39,184 @@ protected:
 public:
 
 	virtual ~IData() {};
-	IData(std::string, int dim0, int dim1);
+	IData(std::string, int dim0, int dim1, size_t element_bytes);
 
 	std::string name() const;
 	bool is_symbolic() const;
-	std::vector<int> shape() const;
-
-	std::vector<std::shared_ptr<IView>> basis() const
+	const std::vector<int>& shape() const;
+
+	/**
+	 * Memory layout of the storage. Right is row-major, left is column-major.
+	 * 
+	 * @return layout
+	 */
+	Layout layout() const;
+
+	/**
+	 * Alignment of the storage in bytes. For two-dimensional data,
+	 * the contiguous dimension is padded to a multiple of the alignment.
+	 * 
+	 * @return alignment
+	 */
+	size_t alignment() const;
+
+	/**
+	 * Sets the layout, which is used by the next bind or allocate.
+	 *
+	 * @param layout
+	 */
+	void set_layout(Layout layout);
+
+	/**
+	 * Sets the alignment, which is used by the next allocate. The alignment must be
+	 * a power of two and a multiple of the size of an element.
+	 *
+	 * @param alignment
+	 * @return true, if the alignment is valid and was set
+	 */
+	bool set_alignment(size_t alignment);
+
+	const std::vector<std::shared_ptr<IView>>& basis() const
 	{
 		return this->basis_;
 	};
 
-	std::vector<size_t> split_size() const
+	const std::vector<size_t>& split_size() const
 	{
 		return this->split_size_;
 	}
 
+	/**
+	 * Adopts a concrete buffer without copying. The buffer is interpreted
+	 * as dense array with the shape and layout of the data.
+	 * The data is not symbolic afterwards.
+	 *
+	 * @param buffer
+	 */
+	virtual void bind(void* buffer) = 0;
+
+	/**
+	 * Allocates owned storage with the layout and alignment of the data.
+	 * The data is not symbolic afterwards.
+	 */
+	virtual void allocate() = 0;
+
 };
 
 template<typename D>
 class Data : public IData {
 
+public:
+	typedef Kokkos::View<D, Kokkos::LayoutStride, Kokkos::HostSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> storage_type;
+	typedef Kokkos::View<D, Kokkos::LayoutRight, Kokkos::HostSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> right_type;
+	typedef Kokkos::View<D, Kokkos::LayoutLeft, Kokkos::HostSpace, Kokkos::MemoryTraits<Kokkos::Unmanaged>> left_type;
+	typedef Kokkos::View<remove_all_pointers_t<D>*, Kokkos::HostSpace> buffer_type;
+
+private:
+	// Storage of the layout, the contiguous dimension is extended by the padding
+	right_type right_;
+	left_type left_;
+
+	// Storage of either layout with the shape of the data
+	storage_type values_;
+	buffer_type buffer_;
+
+	size_t contiguous_extent() const
+	{
+		std::vector<int> shape = this->shape();
+		return (this->layout_ == Layout::RIGHT) ? shape.back() : shape.front();
+	};
+
+	void bind(remove_all_pointers_t<D>* pointer, size_t leading)
+	{
+		std::vector<int> shape = this->shape();
+		if constexpr (ONEDIM<D>) {
+			this->right_ = right_type(pointer, shape[0]);
+			this->values_ = this->right_;
+		} else if (this->layout_ == Layout::RIGHT) {
+			this->right_ = right_type(pointer, shape[0], leading);
+			this->left_ = left_type();
+			this->values_ = Kokkos::subview(this->right_, std::make_pair(0, shape[0]), std::make_pair(0, shape[1]));
+		} else {
+			this->left_ = left_type(pointer, leading, shape[1]);
+			this->right_ = right_type();
+			this->values_ = Kokkos::subview(this->left_, std::make_pair(0, shape[0]), std::make_pair(0, shape[1]));
+		}
+		this->symbolic_ = false;
+	};
+
 public:
 	friend class APT;
 
 	Data(std::string name, int dim0) requires ONEDIM<D>
-	: IData(name, dim0, 0) {}
+	: IData(name, dim0, 0, sizeof(remove_all_pointers_t<D>)) {}
 
 	Data(std::string name, int dim0, int dim1) requires TWODIM<D>
-	: IData(name, dim0, dim1)
+	: IData(name, dim0, dim1, sizeof(remove_all_pointers_t<D>))
 	{}
 
+	const storage_type& values() const
+	{
+		return this->values_;
+	};
+
+	remove_all_pointers_t<D>& operator () (int dim0) const requires ONEDIM<D>
+	{
+		return this->right_(dim0);
+	};
+
+	remove_all_pointers_t<D>& operator () (int dim0, int dim1) const requires TWODIM<D>
+	{
+		if (this->layout_ == Layout::RIGHT) {
+			return this->right_(dim0, dim1);
+		}
+		return this->left_(dim0, dim1);
+	};
+
+	/**
+	 * Calls f with the storage of the layout, such that loops over the storage are
+	 * compiled for the contiguous dimension of the layout.
+	 *
+	 * @param f callable with either right_type or left_type
+	 */
+	template<typename F>
+	void visit(F f) const
+	{
+		if (ONEDIM<D> || this->layout_ == Layout::RIGHT) {
+			f(this->right_);
+		} else {
+			f(this->left_);
+		}
+	};
+
+	void bind(void* buffer) override
+	{
+		this->buffer_ = buffer_type();
+		this->bind(static_cast<remove_all_pointers_t<D>*>(buffer), this->contiguous_extent());
+	};
+
+	void allocate() override
+	{
+		typedef remove_all_pointers_t<D> T;
+		size_t alignment = this->alignment_;
+		size_t alignment_elements = alignment / sizeof(T);
+
+		std::vector<int> shape = this->shape();
+		size_t leading = this->contiguous_extent();
+		size_t span = leading;
+		if constexpr (TWODIM<D>) {
+			leading = ((leading + alignment_elements - 1) / alignment_elements) * alignment_elements;
+			size_t outer = (this->layout_ == Layout::RIGHT) ? shape.front() : shape.back();
+			span = leading * outer;
+		}
+
+		// Over-allocate to shift the first element to the alignment
+		this->buffer_ = buffer_type(this->name(), span + alignment_elements);
+		uintptr_t address = reinterpret_cast<uintptr_t>(this->buffer_.data());
+		size_t offset = ((alignment - address % alignment) % alignment) / sizeof(T);
+
+		this->bind(this->buffer_.data() + offset, leading);
+	};
+
 };
 }
@@ -1,7 +1,10 @@
+#include <algorithm>
 #include <numeric>
 
 #include "view.h"
 
+thread_local PatternTree::IView::Recorder* PatternTree::IView::Recorder::active_ = nullptr;
+
 std::weak_ptr<PatternTree::IData> PatternTree::IView::data()
 {
 	return this->data_;
@@ -43,9 +46,14 @@ bool PatternTree::IView::is_nested_context() const
 	return this->nested_context_;
 };
 
+size_t PatternTree::IView::element_size() const
+{
+	return this->element_size_;
+};
+
 double PatternTree::IView::kbytes() const
 {
-	return (8.0 * this->elements()) / 1000.0;
+	return ((double) this->element_size_ * this->elements()) / 1000.0;
 }
 
 void PatternTree::IView::set_nested_context(bool nested)
@@ -55,13 +63,97 @@ void PatternTree::IView::set_nested_context(bool nested)
 
 void PatternTree::IView::add_FLOPS(int flops)
 {
-	this->flops_ += flops;
+	this->accesses().flops += flops;
 };
 
 int PatternTree::IView::reset_FLOPS()
 {
-	int temp = this->flops_;
-	this->flops_ = 0;
+	Accesses& accesses = this->accesses();
+	int temp = accesses.flops;
+	accesses.flops = 0;
 
 	return temp;
 };
+
+void PatternTree::IView::record_accesses()
+{
+	Accesses& accesses = this->accesses();
+	accesses.recording = true;
+	accesses.begins.clear();
+	accesses.ends.clear();
+	accesses.elements = 0;
+};
+
+size_t PatternTree::IView::accessed_bytes() const
+{
+	return this->accesses().elements * this->element_size_;
+};
+
+void PatternTree::IView::record(int dim0) const
+{
+	Accesses& accesses = this->accesses();
+	accesses.elements++;
+	if (accesses.begins.empty()) {
+		accesses.begins = { dim0 };
+		accesses.ends = { dim0 + 1 };
+		return;
+	}
+
+	accesses.begins[0] = std::min(accesses.begins[0], dim0);
+	accesses.ends[0] = std::max(accesses.ends[0], dim0 + 1);
+};
+
+void PatternTree::IView::record(int dim0, int dim1) const
+{
+	Accesses& accesses = this->accesses();
+	accesses.elements++;
+	if (accesses.begins.empty()) {
+		accesses.begins = { dim0, dim1 };
+		accesses.ends = { dim0 + 1, dim1 + 1 };
+		return;
+	}
+
+	accesses.begins[0] = std::min(accesses.begins[0], dim0);
+	accesses.ends[0] = std::max(accesses.ends[0], dim0 + 1);
+	accesses.begins[1] = std::min(accesses.begins[1], dim1);
+	accesses.ends[1] = std::max(accesses.ends[1], dim1 + 1);
+};
+
+void PatternTree::IView::record_all() const
+{
+	Accesses& accesses = this->accesses();
+	if (!accesses.recording) {
+		return;
+	}
+
+	accesses.elements += this->elements();
+	accesses.begins = this->begins_;
+	accesses.ends = this->ends_;
+};
+
+std::shared_ptr<PatternTree::IView> PatternTree::IView::accessed()
+{
+	Accesses& accesses = this->accesses();
+	accesses.recording = false;
+	if (accesses.begins.empty()) {
+		return nullptr;
+	}
+
+	std::shared_ptr<IView> view = this->clone();
+	view->shape_.clear();
+	bool empty = false;
+	for (size_t dim = 0; dim < this->begins_.size(); dim++)
+	{
+		int begin = std::clamp(accesses.begins[dim], this->begins_[dim], this->ends_[dim]);
+		int end = std::clamp(accesses.ends[dim], begin, this->ends_[dim]);
+
+		view->begins_[dim] = begin;
+		view->ends_[dim] = end;
+		view->shape_.push_back(end - begin);
+		empty = empty || (end == begin);
+	}
+
+	accesses.begins.clear();
+	accesses.ends.clear();
+	return empty ? nullptr : view;
+};
@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <type_traits>
+#include <unordered_map>
 
 #include "data/data.h"
 #include "data/data_concepts.h"
@@ -11,9 +12,55 @@ namespace PatternTree
 {
 class IView {
 
-int flops_;
+// FLOPS and the bounding box of the indices accessed while recording, empty if none
+struct Accesses
+{
+    bool recording = false;
+    std::vector<int> begins;
+    std::vector<int> ends;
+    size_t elements = 0;
+    int flops = 0;
+};
+
 bool nested_context_;
 std::vector<int> shape_;
+size_t element_size_;
+mutable Accesses accesses_;
+
+public:
+
+    /**
+     * Accesses of the views on the calling thread. While a recorder is active on the
+     * thread, the views record their accesses and FLOPS in the recorder instead of their
+     * own state. Threads, each with a recorder, execute functors symbolically at the
+     * same time, although the functors share the consumed views.
+     */
+    class Recorder {
+
+    static thread_local Recorder* active_;
+
+    std::unordered_map<const IView*, Accesses> accesses_;
+    Recorder* previous_;
+
+    public:
+        Recorder() : accesses_(), previous_(active_) { active_ = this; };
+        ~Recorder() { active_ = this->previous_; };
+
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        Accesses& accesses(const IView& view) { return this->accesses_[&view]; };
+
+        static Recorder* active() { return active_; };
+    };
+
+private:
+
+    Accesses& accesses() const
+    {
+        Recorder* recorder = Recorder::active();
+        return recorder == nullptr ? this->accesses_ : recorder->accesses(*this);
+    };
 
 protected:
     std::weak_ptr<IData> data_;
@@ -21,10 +68,22 @@ protected:
     std::vector<int> begins_;
     std::vector<int> ends_;
 
+    bool is_recording() const { return this->accesses().recording; };
+    void record(int dim0) const;
+    void record(int dim0, int dim1) const;
+
+    // Records an access to the whole view, if recording
+    void record_all() const;
+
 public:
-    IView(std::weak_ptr<IData> data, std::pair<int, int> dim0, std::pair<int, int> dim1)
-    : data_(data), flops_(0), nested_context_(false)
+    IView(std::weak_ptr<IData> data, std::pair<int, int> dim0, std::pair<int, int> dim1, size_t element_size)
+    : nested_context_(false), element_size_(element_size), accesses_(), data_(data)
     {
+        size_t dims = dim1.first >= 0 ? 2 : 1;
+        begins_.reserve(dims);
+        ends_.reserve(dims);
+        shape_.reserve(dims);
+
         begins_.push_back(dim0.first);
         ends_.push_back(dim0.second);
         shape_.push_back(dim0.second - dim0.first);
@@ -42,6 +101,7 @@ public:
     std::vector<int> begins() const;
     std::vector<int> ends() const;
     int elements() const;
+    size_t element_size() const;
     bool is_symbolic() const;
     bool is_nested_context() const;
     double kbytes() const;
@@ -50,6 +110,28 @@ public:
     void add_FLOPS(int);
     int reset_FLOPS();
 
+    /**
+     * Starts recording the indices accessed through the view.
+     */
+    void record_accesses();
+
+    /**
+     * Stops recording and returns the subview bounding the recorded accesses,
+     * clamped to the view. Accesses to the whole view, e.g. through arithmetic
+     * on views, cover the view.
+     *
+     * @return subview or nullptr, if the view was not accessed
+     */
+    std::shared_ptr<IView> accessed();
+
+    /**
+     * Bytes accessed since recording started. Each indexed access counts
+     * one element, an access to the whole view counts all its elements.
+     *
+     * @return bytes
+     */
+    size_t accessed_bytes() const;
+
     virtual std::shared_ptr<IView> clone() const = 0;
     virtual bool disjoint(IView& view) = 0;
 
@@ -80,34 +162,106 @@ public:
         return joined;
     }
 
+    /**
+     * View of the same data and type as the view, covering the given region.
+     *
+     * @param view
+     * @param begins
+     * @param ends
+     * @return view of the region
+     */
+    static std::shared_ptr<IView> region(const IView& view, const std::vector<int>& begins, const std::vector<int>& ends)
+    {
+        std::shared_ptr<IView> region = view.clone();
+        region->begins_ = begins;
+        region->ends_ = ends;
+        region->shape_.clear();
+        for (size_t i = 0; i < begins.size(); i++)
+        {
+            region->shape_.push_back(ends[i] - begins[i]);
+        }
+
+        return region;
+    }
+
+    /**
+     * Rectangle of basis views covered by a view. The basis views of a data
+     * are indexed densely in row-major order, i.e. block (i, j) has the id
+     * i * length_1 + j.
+     */
+    struct BasisRange
+    {
+        size_t begin_0;
+        size_t end_0;
+        size_t begin_1;
+        size_t end_1;
+        size_t length_1;
+
+        bool overlaps(const BasisRange& range) const
+        {
+            return this->begin_0 < range.end_0 && range.begin_0 < this->end_0
+                && this->begin_1 < range.end_1 && range.begin_1 < this->end_1;
+        };
+
+        size_t size() const
+        {
+            return (this->end_0 - this->begin_0) * (this->end_1 - this->begin_1);
+        };
+    };
+
+    static BasisRange basis_range(IView& view)
+    {
+        auto data = view.data_.lock();
+        auto const& split_size = data->split_size();
+
+        BasisRange range = { 0, 1, 0, 1, 1 };
+        range.begin_0 = view.begins_[0] / split_size[0];
+        range.end_0 = (view.ends_[0] + split_size[0] - 1) / split_size[0];
+        if (view.begins_.size() == 2)
+        {
+            range.begin_1 = view.begins_[1] / split_size[1];
+            range.end_1 = (view.ends_[1] + split_size[1] - 1) / split_size[1];
+            range.length_1 = (data->shape()[1] + split_size[1] - 1) / split_size[1];
+        }
+
+        return range;
+    };
+
+    /**
+     * Calls the function with the id of each basis view covered by the view.
+     * Does not allocate.
+     *
+     * @param view
+     * @param func
+     */
+    template<typename F>
+    static void for_each_basis(IView& view, F func)
+    {
+        BasisRange range = IView::basis_range(view);
+        for (size_t i = range.begin_0; i < range.end_0; i++)
+        {
+            for (size_t j = range.begin_1; j < range.end_1; j++)
+            {
+                func(i * range.length_1 + j);
+            }
+        }
+    };
+
+    static std::vector<size_t> basis_ids(IView& view)
+	{
+		std::vector<size_t> ids;
+		IView::for_each_basis(view, [&ids](size_t id) { ids.push_back(id); });
+
+		return ids;
+	};
+
     static std::unordered_set<std::shared_ptr<IView>> as_basis(IView& view)
 	{
 		auto data = view.data().lock();
-		std::unordered_set<std::shared_ptr<IView>> view_basis;
+		auto const& basis = data->basis();
 
-		std::vector<int> begins = view.begins();
-		std::vector<int> ends = view.ends();
-
-		size_t split_0 = data->split_size()[0];
-		int start_0 = floor(begins[0] / (float) split_0);
-		int end_0 = ceil(ends[0] / (float) split_0);
-		for (int i = start_0; i < end_0; i++)
-		{
-			if (begins.size() == 1)
-			{
-				view_basis.insert(data->basis().at(i));
-			} else {
-				size_t split_1 = data->split_size()[1];
-				int start_1 = floor(begins[1] / (float) split_1);
-				int end_1 = ceil(ends[1] / (float) split_1);
-
-				size_t length_1 = ceil(data->shape()[1] / (float) split_1);
-				for (int j = start_1; j < end_1; j++)
-				{
-					view_basis.insert(data->basis().at(i * length_1 + j));
-				}
-			}
-		}
+		std::unordered_set<std::shared_ptr<IView>> view_basis;
+		IView::for_each_basis(view, [&](size_t id) { view_basis.insert(basis[id]); });
 
 		return view_basis;
 	};
@@ -117,38 +271,131 @@ public:
 template<typename D>
 class View: public IView {
 
-remove_all_pointers_t<D> dummy_;
+Data<D>* storage_;
+
+// Element accessed through views of symbolic data, one per thread
+static remove_all_pointers_t<D>& sink()
+{
+    thread_local remove_all_pointers_t<D> value;
+    value = 0;
+    return value;
+};
 
 std::shared_ptr<View<D>> clone_() const requires ONEDIM<D> 
 {
-    std::shared_ptr<View<D>> view(new View<D>(
+    std::shared_ptr<View<D>> view = std::make_shared<View<D>>(
         this->data(),
         std::make_pair(this->begins_.at(0), this->ends_.at(0))
-    ));
+    );
 
     return view;
 };
 
 std::shared_ptr<View<D>> clone_() const requires TWODIM<D>
 {
-    std::shared_ptr<View<D>> view(new View<D>(
+    std::shared_ptr<View<D>> view = std::make_shared<View<D>>(
         this->data(),
         std::make_pair(this->begins_.at(0), this->ends_.at(0)),
         std::make_pair(this->begins_.at(1), this->ends_.at(1))
-    ));
+    );
 
     return view;
 };
 
+/**
+ * Applies f to each element of the view in the bound storage.
+ */
+template<typename F>
+void apply(F f) requires ONEDIM<D>
+{
+    this->storage_->visit([&](auto& values) {
+        for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+        {
+            f(values(i));
+        }
+    });
+};
+
+template<typename F>
+void apply(F f) requires TWODIM<D>
+{
+    this->storage_->visit([&](auto& values) {
+        // Innermost loop over the contiguous dimension of the layout
+        if constexpr (std::is_same_v<typename std::decay_t<decltype(values)>::array_layout, Kokkos::LayoutLeft>) {
+            for (int j = this->begins_[1]; j < this->ends_[1]; j++)
+            {
+                for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+                {
+                    f(values(i, j));
+                }
+            }
+        } else {
+            for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+            {
+                for (int j = this->begins_[1]; j < this->ends_[1]; j++)
+                {
+                    f(values(i, j));
+                }
+            }
+        }
+    });
+};
+
+/**
+ * Applies f element-wise to the view and rhs in the bound storage.
+ * Both views are expected to have the same shape.
+ */
+template<typename F>
+void apply(const View<D>& rhs, F f) requires ONEDIM<D>
+{
+    int offset_0 = rhs.begins_[0] - this->begins_[0];
+    this->storage_->visit([&](auto& values) {
+        rhs.storage_->visit([&](auto& rhs_values) {
+            for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+            {
+                f(values(i), rhs_values(i + offset_0));
+            }
+        });
+    });
+};
+
+template<typename F>
+void apply(const View<D>& rhs, F f) requires TWODIM<D>
+{
+    int offset_0 = rhs.begins_[0] - this->begins_[0];
+    int offset_1 = rhs.begins_[1] - this->begins_[1];
+    this->storage_->visit([&](auto& values) {
+        rhs.storage_->visit([&](auto& rhs_values) {
+            if constexpr (std::is_same_v<typename std::decay_t<decltype(values)>::array_layout, Kokkos::LayoutLeft>) {
+                for (int j = this->begins_[1]; j < this->ends_[1]; j++)
+                {
+                    for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+                    {
+                        f(values(i, j), rhs_values(i + offset_0, j + offset_1));
+                    }
+                }
+            } else {
+                for (int i = this->begins_[0]; i < this->ends_[0]; i++)
+                {
+                    for (int j = this->begins_[1]; j < this->ends_[1]; j++)
+                    {
+                        f(values(i, j), rhs_values(i + offset_0, j + offset_1));
+                    }
+                }
+            }
+        });
+    });
+};
+
 public:
     View(std::weak_ptr<Data<D>> data, std::pair<int, int> dim0) requires ONEDIM<D>
-        : IView(data, dim0, std::make_pair(-1, -1)),
-        dummy_(0)
+        : IView(data, dim0, std::make_pair(-1, -1), sizeof(remove_all_pointers_t<D>)),
+        storage_(data.lock().get())
     {};
 
     View(std::weak_ptr<Data<D>> data, std::pair<int, int> dim0, std::pair<int, int> dim1) requires TWODIM<D>
-        : IView(data, dim0, dim1),
-        dummy_(0)
+        : IView(data, dim0, dim1, sizeof(remove_all_pointers_t<D>)),
+        storage_(data.lock().get())
     {};
 
     std::weak_ptr<Data<D>> data() const
@@ -161,35 +408,97 @@ public:
         return this->clone_();
     };
 
+    /**
+     * Storage of the view as Kokkos subview of the bound data.
+     * Indices of the subview are relative to the begins of the view.
+     *
+     * @return subview
+     */
+    typename Data<D>::storage_type values() const requires ONEDIM<D>
+    {
+        return Kokkos::subview(this->storage_->values(), std::make_pair(this->begins_[0], this->ends_[0]));
+    };
+
+    typename Data<D>::storage_type values() const requires TWODIM<D>
+    {
+        return Kokkos::subview(
+            this->storage_->values(),
+            std::make_pair(this->begins_[0], this->ends_[0]),
+            std::make_pair(this->begins_[1], this->ends_[1])
+        );
+    };
+
     remove_all_pointers_t<D>& operator () (int dim0) requires ONEDIM<D> {
-        this->dummy_ = 0;
-        return dummy_;
+        if (this->is_recording()) {
+            this->record(dim0);
+        }
+
+        if (this->storage_->is_symbolic()) {
+            return View<D>::sink();
+        }
+
+        return (*this->storage_)(dim0);
     }
 
     remove_all_pointers_t<D>& operator () (int dim0, int dim1) requires TWODIM<D> {
-        this->dummy_ = 0;
-        return dummy_;
+        if (this->is_recording()) {
+            this->record(dim0, dim1);
+        }
+
+        if (this->storage_->is_symbolic()) {
+            return View<D>::sink();
+        }
+
+        return (*this->storage_)(dim0, dim1);
     }
 
     View<D>& operator =(const View<D>& rhs)
     {
+        this->record_all();
+        if (this != &rhs) {
+            rhs.record_all();
+        }
+
+        if (this != &rhs && !this->storage_->is_symbolic()) {
+            this->apply(rhs, [](auto& value, auto rhs_value) { value = rhs_value; });
+        }
         return *this;
     }
 
     View<D>& operator =(remove_all_pointers_t<D> rhs)
     {
+        this->record_all();
+
+        if (!this->storage_->is_symbolic()) {
+            this->apply([rhs](auto& value) { value = rhs; });
+        }
         return *this;
     }
 
     friend View<D>& operator +(View<D>& lhs, const View<D>& rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+        rhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply(rhs, [](auto& value, auto rhs_value) { value = value + rhs_value; });
         return lhs;
     }
 
     friend View<D>& operator +(View<D>& lhs, remove_all_pointers_t<D> rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply([rhs](auto& value) { value = value + rhs; });
         return lhs;
     }
 
@@ -200,30 +509,67 @@ public:
 
     friend View<D>& operator -(View<D>& lhs, const View<D>& rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+        rhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply(rhs, [](auto& value, auto rhs_value) { value = value - rhs_value; });
         return lhs;
     }
 
     friend View<D>& operator -(View<D>& lhs, remove_all_pointers_t<D> rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply([rhs](auto& value) { value = value - rhs; });
         return lhs;
     }
 
     friend View<D>& operator -(remove_all_pointers_t<D> lhs, View<D>& rhs)
     {
-        return rhs - lhs;
+        rhs.record_all();
+
+        if (rhs.storage_->is_symbolic()) {
+            return rhs - lhs;
+        }
+
+        rhs.apply([lhs](auto& value) { value = lhs - value; });
+        return rhs;
     }
 
-        friend View<D>& operator *(View<D>& lhs, const View<D>& rhs)
+    friend View<D>& operator *(View<D>& lhs, const View<D>& rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+        rhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply(rhs, [](auto& value, auto rhs_value) { value = value * rhs_value; });
         return lhs;
     }
 
     friend View<D>& operator *(View<D>& lhs, remove_all_pointers_t<D> rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply([rhs](auto& value) { value = value * rhs; });
         return lhs;
     }
 
@@ -232,31 +578,53 @@ public:
         return rhs * lhs;
     }
 
-        friend View<D>& operator /(View<D>& lhs, const View<D>& rhs)
+    friend View<D>& operator /(View<D>& lhs, const View<D>& rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+        rhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply(rhs, [](auto& value, auto rhs_value) { value = value / rhs_value; });
         return lhs;
     }
 
     friend View<D>& operator /(View<D>& lhs, remove_all_pointers_t<D> rhs)
     {
-        lhs.add_FLOPS(1 * lhs.elements());
+        lhs.record_all();
+
+        if (lhs.storage_->is_symbolic()) {
+            lhs.add_FLOPS(1 * lhs.elements());
+            return lhs;
+        }
+
+        lhs.apply([rhs](auto& value) { value = value / rhs; });
         return lhs;
     }
 
     friend View<D>& operator /(remove_all_pointers_t<D> lhs, View<D>& rhs)
     {
-        return rhs / lhs;
+        rhs.record_all();
+
+        if (rhs.storage_->is_symbolic()) {
+            return rhs / lhs;
+        }
+
+        rhs.apply([lhs](auto& value) { value = lhs / value; });
+        return rhs;
     }
 
     static std::shared_ptr<View<D>> slice(std::weak_ptr<Data<D>> data, std::pair<int,int> dim0) requires ONEDIM<D>
     {
-        return std::shared_ptr<View<D>>(new View<D>(data, dim0));
+        return std::make_shared<View<D>>(data, dim0);
     };
 
     static std::shared_ptr<View<D>> slice(std::weak_ptr<Data<D>> data, std::pair<int,int> dim0, std::pair<int,int> dim1) requires TWODIM<D>
     {
-        return std::shared_ptr<View<D>>(new View<D>(data, dim0, dim1));
+        return std::make_shared<View<D>>(data, dim0, dim1);
     };
 
     static std::shared_ptr<View<D>> element(std::weak_ptr<Data<D>> data, int index) requires ONEDIM<D>
@@ -321,53 +689,11 @@ public:
         return !std::is_same<D, T>::value;
     };
 
-    bool disjoint(View<D>& view) requires ONEDIM<D>
+    bool disjoint(View<D>& view)
     {
-        if (this->data().lock() != view.data().lock()) { return true; }
-
-        // O(1) heuristic: If not overlapping -> return false
-        // TODO: extend bounds with split sizes 
-        //bool overlapping = (this->ends_[0] > view.begins_[0] && this->begins_[0] < view.ends_[0])
-        //|| (view.ends_[0] > this->begins_[0] && view.begins_[0] < this->ends_[0]);
-
-        auto basis_lhs = IView::as_basis(*this);
-        auto basis_rhs = IView::as_basis(view);
+        if (this->data_.lock() != view.data_.lock()) { return true; }
 
-        for (auto const& basis_view : basis_rhs)
-        {
-            if (basis_lhs.find(basis_view) != basis_lhs.end())
-            {
-                return false;
-            }
-        }
-
-        return true;
-    };
-
-    bool disjoint(View<D>& view) requires TWODIM<D>
-    {
-        if (this->data().lock() != view.data().lock()) { return true; }
-
-        // O(1) heuristic: If not overlapping -> return false
-        // TODO: extend bounds with split sizes 
-        //bool overlapping = !(((this->ends_[0] > view.begins_[0] && this->begins_[0] < view.ends_[0])
-        //    || (view.ends_[0] > this->begins_[0] && view.begins_[0] < this->ends_[0]))
-        //&& 
-        //    (((this->ends_[1] > view.begins_[1] && this->begins_[1] < view.ends_[1])
-        //    || (view.ends_[1] > this->begins_[1] && view.begins_[1] < this->ends_[1]))));
-
-        auto basis_lhs = IView::as_basis(*this);
-        auto basis_rhs = IView::as_basis(view);
-
-        for (auto const& basis_view : basis_rhs)
-        {
-            if (basis_lhs.find(basis_view) != basis_lhs.end())
-            {
-                return false;
-            }
-        }
-
-        return true;
+        return !IView::basis_range(*this).overlaps(IView::basis_range(view));
     };
 
 };
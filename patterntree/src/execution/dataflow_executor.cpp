@@ -0,0 +1,177 @@
+#include "dataflow_executor.h"
+
+#include <algorithm>
+#include <set>
+#include <unordered_map>
+
+#include <Kokkos_Core.hpp>
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+#include <omp.h>
+#endif
+
+PatternTree::DataflowExecutor::DataflowExecutor()
+: DataflowExecutor(64)
+{};
+
+PatternTree::DataflowExecutor::DataflowExecutor(size_t grain_size)
+: grain_size_(std::max(grain_size, (size_t) 1)), tasks_(), successors_(), dependencies_()
+{};
+
+size_t PatternTree::DataflowExecutor::size() const
+{
+    return this->tasks_.size();
+};
+
+const PatternTree::PatternSplit& PatternTree::DataflowExecutor::split(size_t task) const
+{
+    return *(this->tasks_.at(task));
+};
+
+int PatternTree::DataflowExecutor::dependencies(size_t task) const
+{
+    return this->dependencies_.at(task);
+};
+
+const std::vector<size_t>& PatternTree::DataflowExecutor::successors(size_t task) const
+{
+    return this->successors_.at(task);
+};
+
+void PatternTree::DataflowExecutor::build(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end)
+{
+    this->tasks_.clear();
+    this->successors_.clear();
+    this->dependencies_.clear();
+
+    // Splits of the latest step writing a basis view and the splits reading it since
+    std::unordered_map<const PatternTree::IView*, std::vector<size_t>> writers;
+    std::unordered_map<const PatternTree::IView*, std::vector<size_t>> readers;
+
+    for (auto iter = begin; iter != end; iter++)
+    {
+        std::unordered_map<const PatternTree::IView*, std::vector<size_t>> step_writers;
+        std::unordered_map<const PatternTree::IView*, std::vector<size_t>> step_readers;
+
+        for (auto const& split_ : iter->splits())
+        {
+            const PatternTree::PatternSplit& split = split_.get();
+            size_t task = this->tasks_.size();
+            this->tasks_.push_back(&split);
+            this->successors_.push_back({});
+
+            std::set<size_t> predecessors;
+            for (auto const& view : split.consumes())
+            {
+                auto data = view->data().lock();
+                auto const& basis = data->basis();
+                PatternTree::IView::for_each_basis(*view, [&](size_t id) {
+                    const PatternTree::IView* basis_view = basis[id].get();
+                    auto it = writers.find(basis_view);
+                    if (it != writers.end())
+                    {
+                        predecessors.insert(it->second.begin(), it->second.end());
+                    }
+                    step_readers[basis_view].push_back(task);
+                });
+            }
+            for (auto const& view : split.produces())
+            {
+                auto data = view->data().lock();
+                auto const& basis = data->basis();
+                PatternTree::IView::for_each_basis(*view, [&](size_t id) {
+                    const PatternTree::IView* basis_view = basis[id].get();
+                    auto it = writers.find(basis_view);
+                    if (it != writers.end())
+                    {
+                        predecessors.insert(it->second.begin(), it->second.end());
+                    }
+                    it = readers.find(basis_view);
+                    if (it != readers.end())
+                    {
+                        predecessors.insert(it->second.begin(), it->second.end());
+                    }
+                    step_writers[basis_view].push_back(task);
+                });
+            }
+
+            for (auto const& predecessor : predecessors)
+            {
+                this->successors_[predecessor].push_back(task);
+            }
+            this->dependencies_.push_back(predecessors.size());
+        }
+
+        for (auto& entry : step_writers)
+        {
+            writers[entry.first] = entry.second;
+            readers[entry.first].clear();
+        }
+        for (auto& entry : step_readers)
+        {
+            auto& basis_readers = readers[entry.first];
+            basis_readers.insert(basis_readers.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+};
+
+void PatternTree::DataflowExecutor::execute(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end)
+{
+    this->build(begin, end);
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+    std::vector<std::atomic<int>> pending(this->tasks_.size());
+    for (size_t task = 0; task < this->tasks_.size(); task++)
+    {
+        pending[task] = this->dependencies_[task];
+    }
+
+    #pragma omp parallel
+    #pragma omp single
+    {
+        for (size_t task = 0; task < this->tasks_.size(); task++)
+        {
+            if (this->dependencies_[task] == 0)
+            {
+                #pragma omp task firstprivate(task) shared(pending)
+                this->run(task, pending);
+            }
+        }
+    }
+#else
+    // Tasks are created in a topological order
+    for (auto const& split : this->tasks_)
+    {
+        split->pattern().execute(split->begin(), split->end());
+    }
+#endif
+
+    Kokkos::fence();
+};
+
+void PatternTree::DataflowExecutor::run(size_t task, std::vector<std::atomic<int>>& pending)
+{
+    const PatternTree::PatternSplit& split = *(this->tasks_[task]);
+    size_t grain_size = this->grain_size_;
+    size_t chunks = (split.width() + grain_size - 1) / grain_size;
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+    // Kokkos executes the chunks serially inside the parallel region
+    #pragma omp taskloop
+    for (size_t chunk = 0; chunk < chunks; chunk++)
+    {
+        size_t chunk_begin = split.begin() + chunk * grain_size;
+        size_t chunk_end = std::min(chunk_begin + grain_size, split.end());
+        split.pattern().execute(chunk_begin, chunk_end);
+    }
+
+    for (size_t successor : this->successors_[task])
+    {
+        if (--pending[successor] == 0)
+        {
+            #pragma omp task firstprivate(successor) shared(pending)
+            this->run(successor, pending);
+        }
+    }
+#endif
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "apt/step.h"
+#include "execution/executor.h"
+#include "patterns/pattern_split.h"
+
+namespace PatternTree
+{
+class DataflowExecutor : public IExecutor {
+
+size_t grain_size_;
+std::vector<const PatternSplit*> tasks_;
+std::vector<std::vector<size_t>> successors_;
+std::vector<int> dependencies_;
+
+void run(size_t task, std::vector<std::atomic<int>>& pending);
+
+public:
+    DataflowExecutor();
+    DataflowExecutor(size_t grain_size);
+
+    /**
+     * Executes the splits of the steps without barriers between steps.
+     * A split starts as soon as all splits writing the basis views it
+     * consumes and all splits reading the basis views it produces are completed.
+     * Ready splits are chunked into tasks of grain size indices and scheduled
+     * by work-stealing on the host. Assignments to teams are not enforced.
+     *
+     * @param begin
+     * @param end
+     */
+    void execute(APT::Iterator begin, APT::Iterator end) override;
+
+    /**
+     * Builds the dependency graph over the splits of the steps.
+     * Splits of the same step are independent.
+     *
+     * @param begin
+     * @param end
+     */
+    void build(APT::Iterator begin, APT::Iterator end);
+
+    size_t size() const;
+    const PatternSplit& split(size_t task) const;
+    int dependencies(size_t task) const;
+    const std::vector<size_t>& successors(size_t task) const;
+};
+}
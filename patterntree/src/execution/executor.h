@@ -0,0 +1,20 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/step.h>
+
+namespace PatternTree
+{
+
+class IExecutor {
+    public:
+        /**
+         * Executes the steps in [begin, end) on the bound data.
+         *
+         * @param begin
+         * @param end
+         */
+        virtual void execute(APT::Iterator begin, APT::Iterator end) = 0;
+};
+
+}
@@ -0,0 +1,117 @@
+#include "step_executor.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+#include <omp.h>
+#endif
+
+PatternTree::StepExecutor::StepExecutor()
+{
+#if defined(KOKKOS_ENABLE_OPENMP)
+    // Teams run their splits in nested parallel regions
+    if (omp_get_max_active_levels() < 2)
+    {
+        omp_set_max_active_levels(2);
+    }
+#endif
+};
+
+void PatternTree::StepExecutor::execute(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end)
+{
+    for (auto iter = begin; iter != end; iter++)
+    {
+        this->execute(*iter);
+    }
+};
+
+void PatternTree::StepExecutor::execute(PatternTree::Step& step)
+{
+    std::vector<std::shared_ptr<PatternTree::Team>> teams;
+    std::vector<std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>> assigned;
+    for (auto const& team : step.teams())
+    {
+        teams.push_back(team);
+        assigned.push_back(step.assigned(*team));
+    }
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+    // Threads of each team in proportion to its cores, if the teams exceed the thread pool
+    int concurrency = Kokkos::OpenMP::concurrency();
+    long total = 0;
+    for (auto const& team : teams)
+    {
+        total += team->cores();
+    }
+
+    std::vector<int> threads;
+    for (auto const& team : teams)
+    {
+        threads.push_back(std::max(1L, team->cores() * std::min(total, (long) concurrency) / total));
+    }
+
+    // One task per team, each team runs its splits in a nested region of its threads
+    #pragma omp parallel for num_threads(std::max((size_t) 1, teams.size())) schedule(static, 1)
+    for (size_t i = 0; i < teams.size(); i++)
+    {
+        for (auto const& split : assigned[i])
+        {
+            PatternTree::StepExecutor::execute(split.get(), threads[i]);
+        }
+    }
+#else
+    for (size_t i = 0; i < teams.size(); i++)
+    {
+        for (auto const& split : assigned[i])
+        {
+            this->execute(split.get(), *(teams[i]));
+        }
+    }
+#endif
+
+    for (auto const& split_ : step.splits())
+    {
+        const PatternTree::PatternSplit& split = split_.get();
+        if (!step.assigned(split).has_value())
+        {
+            split.pattern().execute(split.begin(), split.end());
+        }
+    }
+
+    Kokkos::fence();
+};
+
+void PatternTree::StepExecutor::execute(const PatternTree::PatternSplit& split, const PatternTree::Team& team)
+{
+    if (split.width() == 0) { return; }
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+    PatternTree::StepExecutor::execute(split, std::min(team.cores(), Kokkos::OpenMP::concurrency()));
+#else
+    split.pattern().execute(split.begin(), split.end());
+#endif
+};
+
+void PatternTree::StepExecutor::execute(const PatternTree::PatternSplit& split, int threads)
+{
+    if (split.width() == 0) { return; }
+
+#if defined(KOKKOS_ENABLE_OPENMP)
+    // Kokkos executes serially inside the parallel region, each thread runs a chunk of the split
+    #pragma omp parallel num_threads(threads)
+    {
+        size_t chunk_size = (split.width() + omp_get_num_threads() - 1) / omp_get_num_threads();
+        size_t chunk_begin = split.begin() + omp_get_thread_num() * chunk_size;
+        size_t chunk_end = std::min(chunk_begin + chunk_size, (size_t) split.end());
+        if (chunk_begin < chunk_end)
+        {
+            split.pattern().execute(chunk_begin, chunk_end);
+        }
+    }
+#else
+    split.pattern().execute(split.begin(), split.end());
+#endif
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "apt/step.h"
+#include "cluster/team.h"
+#include "execution/executor.h"
+#include "patterns/pattern_split.h"
+
+namespace PatternTree
+{
+class StepExecutor : public IExecutor {
+
+public:
+    StepExecutor();
+
+    void execute(APT::Iterator begin, APT::Iterator end) override;
+
+    /**
+     * Executes all splits of the step on their assigned teams.
+     * The teams run concurrently, each in a nested region of threads in proportion
+     * to its cores.
+     * Splits without assignment run afterwards on the full host execution space.
+     * Returns after all splits of the step are completed.
+     *
+     * @param step
+     */
+    void execute(Step& step);
+
+    /**
+     * Executes the split in a parallel region of the cores of the team.
+     *
+     * @param split
+     * @param team
+     */
+    void execute(const PatternSplit& split, const Team& team);
+
+private:
+
+    /**
+     * Executes the split in chunks on the threads of a nested parallel region.
+     *
+     * @param split
+     * @param threads
+     */
+    static void execute(const PatternSplit& split, int threads);
+};
+}
@@ -12,6 +12,14 @@ class IOptimizer {
         virtual void init(APT::Iterator begin, APT::Iterator end, const Cluster& cluster) = 0;
         virtual void assign(APT::Iterator& step) = 0;
         virtual double costs() = 0;
+
+        /**
+         * Notifies the optimizer, that the last assigned steps [begin, end) repeat
+         * trips more times with the same mapping, which the APT assigns without
+         * calling assign, e.g. the remaining iterations of a loop. Only called for
+         * APTs compiled with loop folding, see APT::loop_folding.
+         */
+        virtual void repeat(APT::Iterator, APT::Iterator, size_t) {};
 };
 
 }
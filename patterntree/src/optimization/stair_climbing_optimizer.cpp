@@ -0,0 +1,388 @@
+#include "stair_climbing_optimizer.h"
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <unordered_map>
+
+#include <Kokkos_Core.hpp>
+
+PatternTree::StairClimbingOptimizer::StairClimbingOptimizer()
+: StairClimbingOptimizer({1, 2, 4})
+{};
+
+PatternTree::StairClimbingOptimizer::StairClimbingOptimizer(std::vector<size_t> granularities)
+: StairClimbingOptimizer(granularities, PatternTree::RooflineModel::Variant::SCALAR)
+{};
+
+PatternTree::StairClimbingOptimizer::StairClimbingOptimizer(std::vector<size_t> granularities, PatternTree::RooflineModel::Variant variant)
+: granularities_(granularities), teams_(), variant_(variant), model_(variant)
+{};
+
+const std::vector<std::shared_ptr<PatternTree::Team>>& PatternTree::StairClimbingOptimizer::teams() const
+{
+    return this->teams_;
+};
+
+void PatternTree::StairClimbingOptimizer::init(PatternTree::APT::Iterator, PatternTree::APT::Iterator, const PatternTree::Cluster& cluster)
+{
+    this->model_ = PatternTree::RooflineModel(this->variant_);
+    this->teams_.clear();
+
+    for (auto const& node : cluster.nodes())
+    {
+        for (auto const& device : node.second->devices())
+        {
+            for (auto const& processor : device.second->processors())
+            {
+                std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor.second, processor.second->cores()));
+                this->teams_.push_back(team);
+            }
+        }
+    }
+};
+
+void PatternTree::StairClimbingOptimizer::assign(PatternTree::APT::Iterator& step)
+{
+    if (this->teams_.size() == 0)
+    {
+        // ERROR
+        std::cout << "Error: No processors to assign to" << std::endl;
+        return;
+    }
+
+    // Splits of the step and the index of their team
+    Splits splits;
+    std::vector<size_t> assignment;
+
+    for (auto it = step->begin(); it != step->end(); ++it)
+    {
+        PatternTree::IPattern& pattern = *it;
+        size_t offset = splits.size();
+
+        // Existing mapping of the pattern to the teams, e.g. warm-started from a cached mapping
+        std::vector<size_t> existing_sizes;
+        std::vector<size_t> existing_teams;
+        auto existing = step->splits(pattern);
+        std::sort(existing.begin(), existing.end(), [](const std::reference_wrapper<const PatternTree::PatternSplit>& a, const std::reference_wrapper<const PatternTree::PatternSplit>& b) {
+            return a.get().begin() < b.get().begin();
+        });
+        for (auto const& split : existing)
+        {
+            auto team = step->assigned(split.get());
+            auto t = this->teams_.end();
+            if (team.has_value())
+            {
+                t = std::find_if(this->teams_.begin(), this->teams_.end(), [&team](const std::shared_ptr<PatternTree::Team>& candidate) {
+                    return &(candidate->processor()) == &(team.value()->processor()) && candidate->cores() == team.value()->cores();
+                });
+            }
+
+            if (t == this->teams_.end())
+            {
+                existing_sizes.clear();
+                existing_teams.clear();
+                break;
+            }
+
+            existing_sizes.push_back(split.get().width());
+            existing_teams.push_back(t - this->teams_.begin());
+        }
+
+        double best_costs = std::numeric_limits<double>::max();
+        // Sizes of the splits of the best candidate in index order and the team of each split
+        std::vector<size_t> best_sizes;
+        std::vector<size_t> best_assignment;
+        auto keep = [&](double costs) {
+            if (best_sizes.size() > 0 && costs >= best_costs) { return; }
+
+            best_costs = costs;
+            best_sizes.clear();
+            best_assignment.clear();
+            for (size_t i = offset; i < splits.size(); i++)
+            {
+                best_sizes.push_back(splits[i].get().width());
+                best_assignment.push_back(assignment[i]);
+            }
+        };
+
+        if (existing_sizes.size() > 0)
+        {
+            // Climbs from the existing mapping instead of searching the granularities
+            for (auto const& split : step->split(pattern, existing_sizes))
+            {
+                split.get().flops();
+
+                splits.push_back(split);
+                assignment.push_back(existing_teams[splits.size() - 1 - offset]);
+            }
+            this->climb(splits, assignment, offset);
+            keep(this->costs(splits, assignment));
+        }
+
+        for (auto const& granularity : this->granularities_)
+        {
+            if (existing_sizes.size() > 0) { break; }
+            if (granularity == 0 || granularity > (size_t) pattern.width()) { continue; }
+
+            splits.erase(splits.begin() + offset, splits.end());
+            assignment.resize(offset);
+            for (auto const& split : step->split(pattern, granularity))
+            {
+                // Touches the bounds of the split before evaluating concurrently
+                split.get().flops();
+
+                splits.push_back(split);
+                assignment.push_back(UNASSIGNED);
+                this->assign_greedy(splits, assignment, splits.size() - 1);
+            }
+            this->climb(splits, assignment, offset);
+            keep(this->costs(splits, assignment));
+        }
+
+        // Balanced: a split per team of the best candidate, sized by the throughput of the team
+        std::set<size_t> best_teams(best_assignment.begin(), best_assignment.end());
+        std::vector<size_t> balanced_teams(best_teams.begin(), best_teams.end());
+        std::vector<double> throughputs;
+        for (auto const& t : balanced_teams)
+        {
+            throughputs.push_back(this->model_.peak_flops(this->teams_[t]->processor(), this->teams_[t]->cores()));
+        }
+
+        if (existing_sizes.size() == 0 && balanced_teams.size() > 1 && balanced_teams.size() <= (size_t) pattern.width())
+        {
+            splits.erase(splits.begin() + offset, splits.end());
+            assignment.resize(offset);
+            for (auto const& split : step->split_balanced(pattern, throughputs))
+            {
+                split.get().flops();
+
+                splits.push_back(split);
+                assignment.push_back(balanced_teams[splits.size() - 1 - offset]);
+            }
+            keep(this->costs(splits, assignment));
+        }
+
+        if (best_sizes.size() == 0)
+        {
+            // ERROR
+            std::cout << "Error: No granularity applicable to pattern " << pattern.id() << " (" << pattern.identifier() << ")" << std::endl;
+            return;
+        }
+
+        // Re-splits with the sizes of the best candidate, since touching the bounds of later
+        // candidates refines the samples and would move the boundaries of a balanced split
+        splits.erase(splits.begin() + offset, splits.end());
+        assignment.resize(offset);
+        for (auto const& split : step->split(pattern, best_sizes))
+        {
+            splits.push_back(split);
+        }
+        assignment.insert(assignment.end(), best_assignment.begin(), best_assignment.end());
+    }
+
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        step->assign(splits[i].get(), this->teams_[assignment[i]]);
+    }
+
+    this->model_.update(*step);
+};
+
+double PatternTree::StairClimbingOptimizer::costs()
+{
+    return this->model_.costs();
+};
+
+void PatternTree::StairClimbingOptimizer::repeat(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end, size_t trips)
+{
+    std::vector<PatternTree::Step*> steps;
+    for (auto iter = begin; iter != end; iter++)
+    {
+        steps.push_back(&(*iter));
+    }
+
+    this->model_.repeat(steps, trips);
+};
+
+std::vector<PatternTree::StairClimbingOptimizer::Splits> PatternTree::StairClimbingOptimizer::groups(const Splits& splits, const std::vector<size_t>& assignment) const
+{
+    std::vector<Splits> groups(this->teams_.size());
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        if (assignment[i] != UNASSIGNED)
+        {
+            groups[assignment[i]].push_back(splits[i]);
+        }
+    }
+
+    return groups;
+};
+
+std::vector<double> PatternTree::StairClimbingOptimizer::evaluate(const Splits& splits, const std::vector<size_t>& assignment, const std::vector<std::pair<size_t, size_t>>& moves) const
+{
+    std::vector<Splits> groups = this->groups(splits, assignment);
+
+    std::vector<double> team_costs(this->teams_.size(), 0.0);
+    for (size_t t = 0; t < this->teams_.size(); t++)
+    {
+        if (groups[t].size() > 0)
+        {
+            team_costs[t] = this->model_.costs(groups[t], *(this->teams_[t]));
+        }
+    }
+
+    bool reduces = std::any_of(splits.begin(), splits.end(), [](const std::reference_wrapper<const PatternTree::PatternSplit>& split) {
+        return dynamic_cast<const PatternTree::IReduce*>(&(split.get().pattern())) != nullptr;
+    });
+
+    // Only the teams losing and receiving the split change their costs
+    std::vector<double> costs(moves.size(), 0.0);
+    auto evaluate_move = [&](const int m) {
+        size_t split = moves[m].first;
+        size_t team = moves[m].second;
+        size_t previous = assignment[split];
+
+        double max_costs = 0.0;
+        for (size_t t = 0; t < this->teams_.size(); t++)
+        {
+            double t_costs = team_costs[t];
+            if (t == team)
+            {
+                Splits group = groups[t];
+                group.push_back(splits[split]);
+                t_costs = this->model_.costs(group, *(this->teams_[t]));
+            } else if (t == previous)
+            {
+                Splits group;
+                for (auto const& s : groups[t])
+                {
+                    if (&(s.get()) != &(splits[split].get())) { group.push_back(s); }
+                }
+                t_costs = group.size() > 0 ? this->model_.costs(group, *(this->teams_[t])) : 0.0;
+            }
+
+            max_costs = std::max(max_costs, t_costs);
+        }
+
+        if (reduces)
+        {
+            std::vector<size_t> moved = assignment;
+            moved[split] = team;
+            max_costs += this->combine_costs(splits, moved);
+        }
+
+        costs[m] = max_costs;
+    };
+
+    if (Kokkos::is_initialized())
+    {
+        Kokkos::parallel_for(
+            "PatternTree::StairClimbingOptimizer",
+            Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, moves.size()),
+            evaluate_move
+        );
+    } else {
+        for (size_t m = 0; m < moves.size(); m++)
+        {
+            evaluate_move(m);
+        }
+    }
+
+    return costs;
+};
+
+void PatternTree::StairClimbingOptimizer::assign_greedy(const Splits& splits, std::vector<size_t>& assignment, size_t split) const
+{
+    std::vector<std::pair<size_t, size_t>> moves;
+    for (size_t t = 0; t < this->teams_.size(); t++)
+    {
+        moves.push_back({split, t});
+    }
+
+    std::vector<double> costs = this->evaluate(splits, assignment, moves);
+    size_t best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+    assignment[split] = moves[best].second;
+};
+
+void PatternTree::StairClimbingOptimizer::climb(const Splits& splits, std::vector<size_t>& assignment, size_t offset) const
+{
+    double current_costs = this->costs(splits, assignment);
+    while (true)
+    {
+        std::vector<std::pair<size_t, size_t>> moves;
+        for (size_t i = offset; i < splits.size(); i++)
+        {
+            for (size_t t = 0; t < this->teams_.size(); t++)
+            {
+                if (t != assignment[i]) { moves.push_back({i, t}); }
+            }
+        }
+        if (moves.size() == 0) { return; }
+
+        std::vector<double> costs = this->evaluate(splits, assignment, moves);
+        size_t best = std::min_element(costs.begin(), costs.end()) - costs.begin();
+
+        // Ignore improvements within the rounding of the costs
+        if (costs[best] >= (1.0 - COSTS_TOLERANCE) * current_costs) { return; }
+
+        // Moves are evaluated on exclusive links, the move must also pay off with shared links
+        std::vector<size_t> moved = assignment;
+        moved[moves[best].first] = moves[best].second;
+        double moved_costs = this->costs(splits, moved);
+        if (moved_costs >= (1.0 - COSTS_TOLERANCE) * current_costs) { return; }
+
+        assignment = moved;
+        current_costs = moved_costs;
+    }
+};
+
+double PatternTree::StairClimbingOptimizer::costs(const Splits& splits, const std::vector<size_t>& assignment) const
+{
+    std::vector<Splits> groups;
+    std::vector<const PatternTree::Team*> teams;
+    std::vector<Splits> team_groups = this->groups(splits, assignment);
+    for (size_t t = 0; t < this->teams_.size(); t++)
+    {
+        if (team_groups[t].size() > 0)
+        {
+            groups.push_back(team_groups[t]);
+            teams.push_back(this->teams_[t].get());
+        }
+    }
+
+    // Teams pulling data over the same link of the cluster share its bandwidth
+    double max_costs = 0.0;
+    for (auto const& team_costs : this->model_.costs(groups, teams))
+    {
+        max_costs = std::max(max_costs, team_costs);
+    }
+
+    return max_costs + this->combine_costs(splits, assignment);
+};
+
+double PatternTree::StairClimbingOptimizer::combine_costs(const Splits& splits, const std::vector<size_t>& assignment) const
+{
+    std::unordered_map<const PatternTree::IReduce*, std::set<size_t>> teams;
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        auto reduce = dynamic_cast<const PatternTree::IReduce*>(&(splits[i].get().pattern()));
+        if (reduce != nullptr && assignment[i] != UNASSIGNED)
+        {
+            teams[reduce].insert(assignment[i]);
+        }
+    }
+
+    double costs = 0.0;
+    for (auto const& entry : teams)
+    {
+        std::vector<const PatternTree::Team*> reduce_teams;
+        for (auto const& t : entry.second)
+        {
+            reduce_teams.push_back(this->teams_[t].get());
+        }
+        costs += this->model_.combine_costs(*(entry.first), reduce_teams);
+    }
+
+    return costs;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "optimization/optimizer.h"
+#include "performance/roofline_model.h"
+
+namespace PatternTree
+{
+
+/**
+ * Maps the APT step by step. For each pattern of a step, the optimizer splits the
+ * pattern into each granularity, assigns the splits greedily to the teams and
+ * then climbs down by applying the best reassignment of a single split as long
+ * as the costs of the step decrease. The teams of the best granularity then receive a
+ * balanced split each, sized by the peak FLOPS of the team on the cumulative FLOPS of
+ * the pattern. The candidate with the lowest costs is kept. Patterns, whose splits are
+ * already assigned to the teams, e.g. warm-started from a cached mapping, are not searched
+ * and only climb down from their existing mapping.
+ *
+ * Teams span all cores of a processor, one team per processor of the cluster.
+ * Costs are estimated with the roofline model of the given variant, including the costs of combining
+ * the partial results of reductions split across teams. Candidate moves are ranked on exclusive links,
+ * while candidates and accepted moves are costed with teams sharing the links of the cluster. The candidate reassignments are
+ * evaluated concurrently on the host execution space if Kokkos is initialized.
+ */
+class StairClimbingOptimizer : public IOptimizer {
+
+typedef std::vector<std::reference_wrapper<const PatternSplit>> Splits;
+
+std::vector<size_t> granularities_;
+std::vector<std::shared_ptr<Team>> teams_;
+RooflineModel::Variant variant_;
+RooflineModel model_;
+
+static constexpr double COSTS_TOLERANCE = 1e-9;
+static constexpr size_t UNASSIGNED = (size_t) -1;
+
+std::vector<Splits> groups(const Splits& splits, const std::vector<size_t>& assignment) const;
+std::vector<double> evaluate(const Splits& splits, const std::vector<size_t>& assignment, const std::vector<std::pair<size_t, size_t>>& moves) const;
+void assign_greedy(const Splits& splits, std::vector<size_t>& assignment, size_t split) const;
+void climb(const Splits& splits, std::vector<size_t>& assignment, size_t offset) const;
+double costs(const Splits& splits, const std::vector<size_t>& assignment) const;
+double combine_costs(const Splits& splits, const std::vector<size_t>& assignment) const;
+
+public:
+    StairClimbingOptimizer();
+    StairClimbingOptimizer(std::vector<size_t> granularities);
+    StairClimbingOptimizer(std::vector<size_t> granularities, RooflineModel::Variant variant);
+
+    const std::vector<std::shared_ptr<Team>>& teams() const;
+
+    void init(APT::Iterator begin, APT::Iterator end, const Cluster& cluster) override;
+    void assign(APT::Iterator& step) override;
+    double costs() override;
+    void repeat(APT::Iterator begin, APT::Iterator end, size_t trips) override;
+};
+
+}
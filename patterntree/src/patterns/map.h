@@ -1,14 +1,19 @@
 #pragma once
 
 #include <functional>
+#include <map>
+#include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <type_traits>
+#include <vector>
 
 
 #include <Kokkos_Core.hpp>
 
 #include "patterns/pattern.h"
+#include "patterns/touch_cache.h"
 #include "data/data.h"
 #include "data/view.h"
 
@@ -22,6 +27,13 @@ struct MapFunctor {
 	virtual void consumes(Dataflow& dataflow) = 0;
 
 	virtual bool touch(const int index, PatternIndexInfo &info) { return false; };
+
+	/**
+	 * Whether the info of the overriden touch only depends on the index and the shapes
+	 * of the field and the consumed views. The info is then shared with all patterns
+	 * of functors of the same type and shapes.
+	 */
+	virtual bool memoize() const { return false; };
 };
 
 template<typename T, typename D>
@@ -51,9 +63,30 @@ static Dataflow out_data(std::shared_ptr<IView> field)
 	return data;
 };
 
+/**
+ * Touches equidistant indices of the field and refines the interpolation between them.
+ */
+void gather(size_t interpolation_frequency)
+{
+	this->interpolation_frequency_ = interpolation_frequency;
+	std::vector<int> shape = this->field_->shape();
+	size_t interpolation_width = std::max(shape[0] / interpolation_frequency, (size_t) 1);
+
+	std::vector<int> indices;
+	for (size_t i = 0; i < shape[0]; i = i + interpolation_width)
+	{
+		indices.push_back(i);
+	}
+	if (indices.back() != shape[0] - 1) {
+		indices.push_back(shape[0] - 1);
+	}
+	this->touch(indices);
+	this->refine(interpolation_frequency);
+};
+
 public:
 	Map(std::string identifier, std::unique_ptr<MapFunctor<D>> func, std::shared_ptr<View<D>> field, Dataflow in_data, Dataflow out_data)
-	: 	IPattern(identifier, in_data, out_data, field->shape().at(0)),
+	: 	IPattern(identifier, std::move(in_data), std::move(out_data), field->shape().at(0)),
 		func_(std::move(func)),
 		field_(field)
 	{};
@@ -62,47 +95,186 @@ public:
 		return View<D>::element(this->field_->data(), index);
 	};
 
+	const std::type_info& functor() const override
+	{
+		return typeid(*(this->func_));
+	};
+
 	void touch(const int index) override
 	{
 			// Option A: Call overriden touch function
 			PatternIndexInfo stats;
 			stats.index = index;
 			if (this->func_->touch(index, stats)) {
-				this->info_[index] = stats;
+				this->info_[index] = std::move(stats);
 				return;
 			}
 
 			// Option B: Execute actual function
-			// - counts flops
-			// - TODO: constructs subviews
+			this->info_[index] = this->symbolic(index);
+	};
+
+private:
+
+	/**
+	 * Executes the functor symbolically for the index:
+	 * - counts flops
+	 * - counts bytes accessed on the consumed views as read and on the element as written
+	 * - constructs subviews bounding the accesses to the consumed views
+	 * Concurrent calls require a recorder of the accesses per thread.
+	 */
+	PatternIndexInfo symbolic(const int index)
+	{
+			PatternIndexInfo stats;
+			stats.index = index;
 
 			std::shared_ptr<Data<D>> data = std::static_pointer_cast<Data<D>>(this->field_->data().lock());
 			std::shared_ptr<View<D>> element = View<D>::element(data, index);
 
+			const Dataflow& consumed = this->consumes();
+			for (auto const& view : consumed)
+			{
+				view->record_accesses();
+			}
+
+			element->record_accesses();
 			element->set_nested_context(true);
 			element->reset_FLOPS();
 			func_.get()->operator()(index, *element);
 			element->set_nested_context(false);
+			element->accessed();
 
 			stats.flops = element->reset_FLOPS();
-			this->info_[index] = stats;
+			stats.bytes_written = element->accessed_bytes();
+
+			// The element is accessed in any case
+			stats.subviews[data.get()] = element;
+
+			// Data, of which a consumed view is not accessed through indices, falls back to the superview
+			std::unordered_set<IData*> unknown;
+			for (auto const& view : consumed)
+			{
+				IData* view_data = view->data().lock().get();
+				stats.bytes_read += view->accessed_bytes();
+				std::shared_ptr<IView> accessed = view->accessed();
+				if (accessed == nullptr) {
+					if (view_data != data.get()) {
+						unknown.insert(view_data);
+					}
+					continue;
+				}
+
+				auto subview = stats.subviews.find(view_data);
+				if (subview == stats.subviews.end()) {
+					stats.subviews.insert({view_data, accessed});
+				} else {
+					subview->second = IView::join(*(subview->second), *accessed);
+				}
+			}
+			for (auto const& view_data : unknown)
+			{
+				stats.subviews.erase(view_data);
+			}
+
+			return stats;
+	};
+
+public:
+
+	void execute(const size_t begin, const size_t end) override
+	{
+		std::shared_ptr<Data<D>> data = std::static_pointer_cast<Data<D>>(this->field_->data().lock());
+		MapFunctor<D>* func = this->func_.get();
+		int dim1 = data->shape().back();
+
+		Kokkos::parallel_for("PatternTree::Map", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(begin, end), [=](const int index) {
+			if constexpr (ONEDIM<D>) {
+				View<D> element(data, std::make_pair(index, index + 1));
+				func->operator()(index, element);
+			} else {
+				View<D> element(data, std::make_pair(index, index + 1), std::make_pair(0, dim1));
+				func->operator()(index, element);
+			}
+		});
 	};
 	
+	/**
+	 * Touches the indices concurrently. The overriden touch of the functor does not
+	 * modify the functor. Indices, for which the functor has no touch, execute the
+	 * functor symbolically, where each index records its accesses on the shared
+	 * consumed views in a recorder of its own.
+	 */
+	void touch(const std::vector<int>& indices) override
+	{
+		std::string key;
+		if (this->func_->memoize()) {
+			key = TouchCache::key(typeid(*(this->func_)), this->consumes());
+			if (TouchCache::instance().find(key, indices, this->info_)) {
+				return;
+			}
+		}
+
+		std::vector<PatternIndexInfo> infos(indices.size());
+		std::vector<char> touched(indices.size(), false);
+		MapFunctor<D>* func = this->func_.get();
+
+		auto touch_index = [&](const int i) {
+			infos[i].index = indices[i];
+			touched[i] = func->touch(indices[i], infos[i]);
+			if (!touched[i]) {
+				IView::Recorder recorder;
+				infos[i] = this->symbolic(indices[i]);
+			}
+		};
+
+		if (Kokkos::is_initialized())
+		{
+			Kokkos::parallel_for("PatternTree::Map::touch", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, indices.size()), touch_index);
+		} else {
+			for (size_t i = 0; i < indices.size(); i++)
+			{
+				touch_index(i);
+			}
+		}
+
+		bool memoizable = !key.empty();
+		std::map<int, PatternIndexInfo> memoized;
+		for (size_t i = 0; i < indices.size(); i++)
+		{
+			// Symbolic execution may depend on the values of the consumed views
+			memoizable = memoizable && touched[i];
+			if (memoizable) {
+				memoized[indices[i]] = infos[i];
+			}
+			this->info_[indices[i]] = std::move(infos[i]);
+		}
+
+		if (memoizable) {
+			TouchCache::instance().insert(key, memoized);
+		}
+	};
+
 	template<typename Functor>
 	static std::unique_ptr<Map<D>> create(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> field, size_t interpolation_frequency) requires MAPFUNCTOR<Functor, D>
 	{
 		Dataflow in_flow = in_data(*functor, field);
 		Dataflow out_flow = out_data(field);
 		std::unique_ptr<Map<D>> map(new Map<D>(identifier, std::move(functor), field, in_flow, out_flow));
+		map->gather(interpolation_frequency);
 
-		// Gather info
-		std::vector<int> shape = field->shape();
-		size_t interpolation_width = std::max(shape[0] / interpolation_frequency, (size_t) 1);
-		for (size_t i = 0; i < shape[0]; i = i + interpolation_width)
-		{
-			map->touch(i);
-		}
-		map->touch(shape[0] - 1);
+		return map;
+	};
+
+	/**
+	 * Creates the map in memory of the allocator, e.g. the arena of an APT.
+	 */
+	template<typename Functor, typename Allocator>
+	static std::shared_ptr<Map<D>> create(const Allocator& allocator, std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> field, size_t interpolation_frequency) requires MAPFUNCTOR<Functor, D>
+	{
+		Dataflow in_flow = in_data(*functor, field);
+		Dataflow out_flow = out_data(field);
+		std::shared_ptr<Map<D>> map = std::allocate_shared<Map<D>>(allocator, identifier, std::move(functor), field, std::move(in_flow), std::move(out_flow));
+		map->gather(interpolation_frequency);
 
 		return map;
 	};
@@ -1,19 +1,29 @@
 #include "pattern.h"
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
 PatternTree::IPattern::IPattern(std::string identifier, PatternTree::Dataflow data_in, PatternTree::Dataflow data_out, int width)
-: 	flow_in_(data_in),
-	flow_out_(data_out),
+: 	flow_in_(std::move(data_in)),
+	flow_out_(std::move(data_out)),
 	width_(width),
 	identifier_(identifier),
-	info_()
+	id_(0),
+	prefix_mutex_(),
+	prefix_samples_(0),
+	flops_prefix_(),
+	bytes_prefix_(),
+	info_(),
+	interpolation_frequency_(0)
 {};
 
-PatternTree::Dataflow PatternTree::IPattern::consumes() const
+const PatternTree::Dataflow& PatternTree::IPattern::consumes() const
 {
 	return this->flow_in_;
 };
 
-PatternTree::Dataflow PatternTree::IPattern::produces() const
+const PatternTree::Dataflow& PatternTree::IPattern::produces() const
 {
 	return this->flow_out_;
 };
@@ -23,27 +33,87 @@ std::string PatternTree::IPattern::identifier() const
 	return this->identifier_;
 }
 
+size_t PatternTree::IPattern::id() const
+{
+	return this->id_;
+};
+
 int PatternTree::IPattern::width() const
 {
 	return this->width_;
 };
 
-double PatternTree::IPattern::flops() const
+size_t PatternTree::IPattern::interpolation_frequency() const
 {
-	double flops_mean = 0.0;
-	for (auto it = info_.begin(); it != info_.end(); it++)
+	return this->interpolation_frequency_;
+};
+
+template<typename F>
+void PatternTree::IPattern::Prefix::build(const std::map<int, PatternTree::PatternIndexInfo>& info, F value)
+{
+	this->indices.clear();
+	this->values.clear();
+	this->sums.clear();
+
+	for (auto it = info.begin(); it != info.end(); it++)
 	{
-		flops_mean += it->second.flops;
+		double v = value(it->second);
+		if (this->indices.empty()) {
+			this->sums.push_back(0.0);
+		} else {
+			// Sum of the interval between the previous and this index
+			double n = it->first - this->indices.back();
+			double slope = (v - this->values.back()) / n;
+			this->sums.push_back(this->sums.back() + n * this->values.back() + slope * n * (n - 1) / 2.0);
+		}
+
+		this->indices.push_back(it->first);
+		this->values.push_back(v);
 	}
-    flops_mean /= this->info_.size();
-	return flops_mean * this->width_;
 };
 
-double PatternTree::IPattern::flops(const int index, bool touch)
+double PatternTree::IPattern::Prefix::sum(const int index) const
+{
+	if (this->indices.empty()) {
+		return 0.0;
+	}
+
+	// Constant before the first and after the last touched index
+	auto it = std::upper_bound(this->indices.begin(), this->indices.end(), index);
+	if (it == this->indices.begin()) {
+		return (index - this->indices.front()) * this->values.front();
+	}
+
+	size_t j = (it - this->indices.begin()) - 1;
+	double t = index - this->indices[j];
+	if (j == this->indices.size() - 1) {
+		return this->sums[j] + t * this->values[j];
+	}
+
+	double slope = (this->values[j + 1] - this->values[j]) / (this->indices[j + 1] - this->indices[j]);
+	return this->sums[j] + t * this->values[j] + slope * t * (t - 1) / 2.0;
+};
+
+std::shared_lock<std::shared_mutex> PatternTree::IPattern::prefix() const
+{
+	{
+		std::unique_lock<std::shared_mutex> lock(this->prefix_mutex_);
+		if (this->prefix_samples_ != this->info_.size()) {
+			this->flops_prefix_.build(this->info_, [](const PatternTree::PatternIndexInfo& info) -> double { return info.flops; });
+			this->bytes_prefix_.build(this->info_, [](const PatternTree::PatternIndexInfo& info) -> double { return info.bytes_read + info.bytes_written; });
+			this->prefix_samples_ = this->info_.size();
+		}
+	}
+
+	return std::shared_lock<std::shared_mutex>(this->prefix_mutex_);
+};
+
+template<typename F>
+double PatternTree::IPattern::interpolate(const int index, bool touch, F value)
 {
 	auto it = this->info_.find(index);
 	if (it != this->info_.end()) {
-		return it->second.flops;
+		return value(it->second);
 	}
 
 	if (!touch) {
@@ -55,13 +125,132 @@ double PatternTree::IPattern::flops(const int index, bool touch)
 		}
 
 		// Linear interpolation
-		double m = (ub->second.flops - lb->second.flops) / (ub->first - lb->first);
-		return m * (index - lb->first) + lb->second.flops;
+		double m = (value(ub->second) - value(lb->second)) / (ub->first - lb->first);
+		return m * (index - lb->first) + value(lb->second);
 	}
 
 	this->touch(index);
 	it = this->info_.find(index);
-	return it->second.flops;
+	return value(it->second);
+};
+
+double PatternTree::IPattern::flops() const
+{
+	return this->range_flops(0, this->width_);
+};
+
+double PatternTree::IPattern::flops(const int index, bool touch)
+{
+	return this->interpolate(index, touch, [](const PatternTree::PatternIndexInfo& info) -> double { return info.flops; });
+};
+
+double PatternTree::IPattern::range_flops(const size_t begin, const size_t end) const
+{
+	auto lock = this->prefix();
+	return this->flops_prefix_.sum(end) - this->flops_prefix_.sum(begin);
+};
+
+double PatternTree::IPattern::bytes() const
+{
+	return this->range_bytes(0, this->width_);
+};
+
+double PatternTree::IPattern::bytes(const int index, bool touch)
+{
+	return this->interpolate(index, touch, [](const PatternTree::PatternIndexInfo& info) -> double { return info.bytes_read + info.bytes_written; });
+};
+
+double PatternTree::IPattern::range_bytes(const size_t begin, const size_t end) const
+{
+	auto lock = this->prefix();
+	return this->bytes_prefix_.sum(end) - this->bytes_prefix_.sum(begin);
+};
+
+void PatternTree::IPattern::touch(const std::vector<int>& indices)
+{
+	for (int index : indices)
+	{
+		this->touch(index);
+	}
+};
+
+void PatternTree::IPattern::refine(size_t budget, double tolerance)
+{
+	auto value = [](const PatternTree::PatternIndexInfo& info) -> double { return info.flops; };
+
+	std::vector<int> candidates;
+	for (auto it = this->info_.begin(); it != this->info_.end(); it++)
+	{
+		candidates.push_back(it->first);
+	}
+
+	while (budget > 0 && candidates.size() > 0)
+	{
+		// Midpoints of the intervals next to deviating indices and their largest deviation
+		std::map<int, double> midpoints;
+		for (int index : candidates)
+		{
+			auto it = this->info_.find(index);
+			if (it == this->info_.begin() || std::next(it) == this->info_.end()) {
+				continue;
+			}
+			auto lb = std::prev(it);
+			auto ub = std::next(it);
+
+			double m = (value(ub->second) - value(lb->second)) / (ub->first - lb->first);
+			double interpolated = m * (index - lb->first) + value(lb->second);
+			double deviation = std::abs(value(it->second) - interpolated) / std::max(std::abs(value(it->second)), 1.0);
+			if (deviation <= tolerance) {
+				continue;
+			}
+
+			if (index - lb->first > 1) {
+				int midpoint = lb->first + (index - lb->first) / 2;
+				midpoints[midpoint] = std::max(midpoints[midpoint], deviation);
+			}
+			if (ub->first - index > 1) {
+				int midpoint = index + (ub->first - index) / 2;
+				midpoints[midpoint] = std::max(midpoints[midpoint], deviation);
+			}
+		}
+
+		if (midpoints.empty()) {
+			break;
+		}
+
+		// Largest deviations first, if the budget does not suffice
+		std::vector<std::pair<int, double>> ordered(midpoints.begin(), midpoints.end());
+		std::stable_sort(ordered.begin(), ordered.end(), [](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+			return a.second > b.second;
+		});
+		if (ordered.size() > budget) {
+			ordered.resize(budget);
+		}
+
+		candidates.clear();
+		for (auto const& midpoint : ordered)
+		{
+			candidates.push_back(midpoint.first);
+		}
+		std::sort(candidates.begin(), candidates.end());
+
+		budget -= candidates.size();
+		this->touch(candidates);
+	}
+};
+
+const std::map<int, PatternTree::PatternIndexInfo>& PatternTree::IPattern::samples() const
+{
+	return this->info_;
+};
+
+void PatternTree::IPattern::restore(std::map<int, PatternTree::PatternIndexInfo> samples)
+{
+	std::unique_lock<std::shared_mutex> lock(this->prefix_mutex_);
+	this->info_ = std::move(samples);
+
+	// Rebuilds the prefix sums on the next query, even if the number of samples did not change
+	this->prefix_samples_ = (size_t) -1;
 };
 
 std::shared_ptr<PatternTree::IView> PatternTree::IPattern::subflow_in(const int index, PatternTree::IData& data)
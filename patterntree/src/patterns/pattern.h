@@ -2,7 +2,10 @@
 
 #include <string>
 #include <map>
+#include <shared_mutex>
+#include <typeinfo>
 #include <unordered_map>
+#include <vector>
 
 #include "data/view.h"
 #include "data/data.h"
@@ -14,32 +17,139 @@ typedef std::vector<std::shared_ptr<IView>> Dataflow;
 struct PatternIndexInfo {
 	int index;
 	size_t flops;
+	size_t bytes_read = 0;
+	size_t bytes_written = 0;
 	std::unordered_map<IData*, std::shared_ptr<IView>> subviews;	
 };
 
+class APT;
+
 class IPattern {
+friend class APT;
+
 std::string identifier_;
+size_t id_;
 int width_;
 Dataflow flow_in_;
 Dataflow flow_out_;
 
+/**
+ * Prefix sums of a value, which is linearly interpolated between the touched indices.
+ */
+struct Prefix {
+	std::vector<int> indices;
+	std::vector<double> values;
+	std::vector<double> sums;
+
+	template<typename F>
+	void build(const std::map<int, PatternIndexInfo>& info, F value);
+
+	/**
+	 * Sum of the interpolated values of the indices before the index,
+	 * relative to the first touched index.
+	 */
+	double sum(const int index) const;
+};
+
+mutable std::shared_mutex prefix_mutex_;
+mutable size_t prefix_samples_;
+mutable Prefix flops_prefix_;
+mutable Prefix bytes_prefix_;
+
+std::shared_lock<std::shared_mutex> prefix() const;
+
+template<typename F>
+double interpolate(const int index, bool touch, F value);
+
 protected:
 	std::map<int, PatternIndexInfo> info_;
+	size_t interpolation_frequency_;
 
 public:
 	IPattern(std::string identifier, Dataflow, Dataflow, int width);
 
 	std::string identifier() const;
+
+	/**
+	 * Dense id of the pattern in the order of insertion into its APT. Cheap to compare
+	 * and stable across runs of the same program.
+	 */
+	size_t id() const;
 	int width() const;
-	Dataflow consumes() const;
-	Dataflow produces() const;
+
+	/**
+	 * Number of indices touched when the pattern was created, before refinement.
+	 */
+	size_t interpolation_frequency() const;
+
+	/**
+	 * Dynamic type of the functor of the pattern.
+	 */
+	virtual const std::type_info& functor() const = 0;
+	const Dataflow& consumes() const;
+	const Dataflow& produces() const;
+
+	static constexpr double REFINEMENT_TOLERANCE = 0.05;
 
 	double flops() const;
 	double flops(const int index, bool touch);
+
+	/**
+	 * FLOPS of the indices in [begin, end), linearly interpolated between the
+	 * touched indices. Queries a prefix sum over the touched indices in O(log n).
+	 *
+	 * @param begin
+	 * @param end
+	 * @return flops
+	 */
+	double range_flops(const size_t begin, const size_t end) const;
+
+	/**
+	 * Bytes read and written by the pattern, as recorded when touching the indices.
+	 */
+	double bytes() const;
+	double bytes(const int index, bool touch);
+	double range_bytes(const size_t begin, const size_t end) const;
+
+	/**
+	 * Touches additional indices, where the FLOPS of a touched index deviate from the
+	 * linear interpolation between its touched neighbours by more than the relative
+	 * tolerance. The intervals next to such an index are bisected, until the
+	 * interpolation is within the tolerance or the budget of touches is spent.
+	 *
+	 * @param budget maximum number of additional touches
+	 * @param tolerance
+	 */
+	void refine(size_t budget, double tolerance = REFINEMENT_TOLERANCE);
+
+	/**
+	 * Infos of the touched indices.
+	 *
+	 * @return infos by index
+	 */
+	const std::map<int, PatternIndexInfo>& samples() const;
+
+	/**
+	 * Replaces the infos of the touched indices, e.g. by the infos of an archived APT.
+	 *
+	 * @param samples infos by index
+	 */
+	void restore(std::map<int, PatternIndexInfo> samples);
+
 	std::shared_ptr<IView> subflow_in(const int index, IData& data);
 	virtual std::shared_ptr<IView> subflow_out(const int index) = 0;
 
 	virtual void touch(const int index) = 0;
+	virtual void touch(const std::vector<int>& indices);
+
+	/**
+	 * Executes the pattern on the bound data for the indices in [begin, end).
+	 * Runs in the calling Kokkos host execution space.
+	 *
+	 * @param begin
+	 * @param end
+	 */
+	virtual void execute(const size_t begin, const size_t end) = 0;
 };
 
 }
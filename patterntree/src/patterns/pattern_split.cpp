@@ -1,5 +1,7 @@
 #include "patterns/pattern_split.h"
 
+#include <limits>
+
 PatternTree::PatternSplit::PatternSplit(
     std::weak_ptr<IPattern> pattern, 
     Dataflow subflow_in,
@@ -46,10 +48,29 @@ int PatternTree::PatternSplit::width() const
 double PatternTree::PatternSplit::flops() const
 {
     auto pattern = this->pattern_.lock();
-    double lb = pattern->flops(this->begin_, true);
-    double ub = pattern->flops(this->end_ - 1, true);
+    pattern->flops(this->begin_, true);
+    pattern->flops(this->end_ - 1, true);
+
+    return pattern->range_flops(this->begin_, this->end_);
+};
+
+double PatternTree::PatternSplit::bytes() const
+{
+    auto pattern = this->pattern_.lock();
+    pattern->bytes(this->begin_, true);
+    pattern->bytes(this->end_ - 1, true);
+
+    return pattern->range_bytes(this->begin_, this->end_);
+};
+
+double PatternTree::PatternSplit::arithmetic_intensity() const
+{
+    double bytes = this->bytes();
+    if (bytes <= 0.0) {
+        return std::numeric_limits<double>::infinity();
+    }
 
-    return (lb + ub) / 2.0 * this->width();
+    return this->flops() / bytes;
 };
 
 const PatternTree::Dataflow& PatternTree::PatternSplit::consumes() const
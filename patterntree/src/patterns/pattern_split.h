@@ -25,6 +25,14 @@ public:
     size_t end() const;
     int width() const;
     double flops() const;
+    double bytes() const;
+
+    /**
+     * FLOPS per byte accessed by the split. Infinite, if no bytes are recorded.
+     *
+     * @return arithmetic intensity
+     */
+    double arithmetic_intensity() const;
 	const Dataflow& consumes() const;
 	const Dataflow& produces() const;
 
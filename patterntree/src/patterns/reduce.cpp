@@ -0,0 +1,5 @@
+#include "reduce.h"
+
+PatternTree::IReduce::IReduce(std::string identifier, PatternTree::Dataflow in_data, PatternTree::Dataflow out_data, int width)
+: 	IPattern(identifier, std::move(in_data), std::move(out_data), width)
+{};
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include "patterns/pattern.h"
+#include "data/data.h"
+#include "data/data_concepts.h"
+#include "data/view.h"
+
+namespace PatternTree
+{
+
+template<typename D>
+struct ReduceFunctor {
+
+	typedef remove_all_pointers_t<D> value_type;
+
+	/**
+	 * Combines two values. The combiner must be associative and commutative,
+	 * since the partial results of the splits are combined in any order.
+	 */
+	virtual value_type operator () (const value_type& lhs, const value_type& rhs) = 0;
+
+	/**
+	 * Number of FLOPS of a single combination.
+	 */
+	virtual size_t flops() { return 1; };
+};
+
+template<typename T, typename D>
+concept REDUCEFUNCTOR = (std::is_base_of<ReduceFunctor<D>, T>::value);
+
+/**
+ * Reduction of a view to a single value. Each split computes a partial
+ * result over its indices, which are then combined across the teams.
+ */
+class IReduce : public IPattern {
+
+public:
+	IReduce(std::string identifier, Dataflow in_data, Dataflow out_data, int width);
+
+	/**
+	 * Size of a partial result transferred between teams.
+	 *
+	 * @return kilobytes
+	 */
+	virtual double partial_kbytes() const = 0;
+
+	/**
+	 * Number of FLOPS to combine two partial results.
+	 *
+	 * @return flops
+	 */
+	virtual size_t combine_flops() const = 0;
+};
+
+template<typename D>
+class Reduce : public IReduce {
+
+typedef remove_all_pointers_t<D> T;
+
+std::unique_ptr<ReduceFunctor<D>> func_;
+std::shared_ptr<View<D>> input_;
+std::shared_ptr<View<D>> result_;
+
+// Serializes the combination of partial results of concurrent splits
+std::mutex mutex_;
+
+static Dataflow in_data(std::shared_ptr<IView> input, std::shared_ptr<IView> result)
+{
+	Dataflow data;
+	data.push_back(input);
+	data.push_back(result);
+
+	return data;
+};
+
+static Dataflow out_data(std::shared_ptr<IView> result)
+{
+	Dataflow data;
+	data.push_back(result);
+
+	return data;
+};
+
+/**
+ * Touches equidistant indices of the input. The FLOPS of a reduction are constant per index.
+ */
+void gather(size_t interpolation_frequency)
+{
+	this->interpolation_frequency_ = interpolation_frequency;
+	std::vector<int> shape = this->input_->shape();
+	size_t interpolation_width = std::max(shape[0] / interpolation_frequency, (size_t) 1);
+	for (size_t i = 0; i < shape[0]; i = i + interpolation_width)
+	{
+		this->touch(i);
+	}
+	this->touch(shape[0] - 1);
+};
+
+public:
+	Reduce(std::string identifier, std::unique_ptr<ReduceFunctor<D>> func, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result, Dataflow in_data, Dataflow out_data) requires ONEDIM<D>
+	: 	IReduce(identifier, std::move(in_data), std::move(out_data), input->shape().at(0)),
+		func_(std::move(func)),
+		input_(input),
+		result_(result)
+	{};
+
+	std::shared_ptr<PatternTree::IView> subflow_out(const int index) override {
+		return this->result_;
+	};
+
+	const std::type_info& functor() const override
+	{
+		return typeid(*(this->func_));
+	};
+
+	void touch(const int index) override
+	{
+		PatternIndexInfo stats;
+		stats.index = index;
+		stats.flops = this->func_->flops();
+		stats.bytes_read = sizeof(T);
+
+		// Each index reads a single element of the input
+		int begin = this->input_->begins()[0];
+		stats.subviews[this->input_->data().lock().get()] = View<D>::element(this->input_->data(), begin + index);
+
+		this->info_[index] = std::move(stats);
+	};
+
+	void execute(const size_t begin, const size_t end) override
+	{
+		if (begin >= end) { return; }
+
+		auto values = this->input_->values();
+		ReduceFunctor<D>* func = this->func_.get();
+
+		size_t chunks = 1;
+#if defined(KOKKOS_ENABLE_OPENMP)
+		chunks = std::max(1, Kokkos::OpenMP::concurrency());
+#endif
+		chunks = std::min(chunks, end - begin);
+		size_t chunk_size = (end - begin + chunks - 1) / chunks;
+		chunks = (end - begin + chunk_size - 1) / chunk_size;
+
+		// Partial results of the chunks, each chunk folds sequentially from its first index
+		std::vector<T> partials(chunks);
+		T* partial = partials.data();
+		Kokkos::parallel_for("PatternTree::Reduce", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(0, chunks), [=](const int chunk) {
+			size_t chunk_begin = begin + chunk * chunk_size;
+			size_t chunk_end = std::min(chunk_begin + chunk_size, end);
+
+			T value = values(chunk_begin);
+			for (size_t i = chunk_begin + 1; i < chunk_end; i++)
+			{
+				value = func->operator()(value, values(i));
+			}
+			partial[chunk] = value;
+		});
+
+		T value = partials[0];
+		for (size_t chunk = 1; chunk < chunks; chunk++)
+		{
+			value = func->operator()(value, partials[chunk]);
+		}
+
+		std::lock_guard<std::mutex> lock(this->mutex_);
+		auto result = this->result_->values();
+		result(0) = func->operator()(result(0), value);
+	};
+
+	double partial_kbytes() const override
+	{
+		return sizeof(T) / 1000.0;
+	};
+
+	size_t combine_flops() const override
+	{
+		return this->func_->flops();
+	};
+
+	template<typename Functor>
+	static std::unique_ptr<Reduce<D>> create(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result, size_t interpolation_frequency) requires REDUCEFUNCTOR<Functor, D> && ONEDIM<D>
+	{
+		Dataflow in_flow = in_data(input, result);
+		Dataflow out_flow = out_data(result);
+		std::unique_ptr<Reduce<D>> reduce(new Reduce<D>(identifier, std::move(functor), input, result, in_flow, out_flow));
+		reduce->gather(interpolation_frequency);
+
+		return reduce;
+	};
+
+	/**
+	 * Creates the reduction in memory of the allocator, e.g. the arena of an APT.
+	 */
+	template<typename Functor, typename Allocator>
+	static std::shared_ptr<Reduce<D>> create(const Allocator& allocator, std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> result, size_t interpolation_frequency) requires REDUCEFUNCTOR<Functor, D> && ONEDIM<D>
+	{
+		Dataflow in_flow = in_data(input, result);
+		Dataflow out_flow = out_data(result);
+		std::shared_ptr<Reduce<D>> reduce = std::allocate_shared<Reduce<D>>(allocator, identifier, std::move(functor), input, result, std::move(in_flow), std::move(out_flow));
+		reduce->gather(interpolation_frequency);
+
+		return reduce;
+	};
+
+};
+
+}
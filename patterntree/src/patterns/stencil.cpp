@@ -0,0 +1 @@
+#include "stencil.h"
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
+
+#include <Kokkos_Core.hpp>
+
+#include "patterns/pattern.h"
+#include "data/data.h"
+#include "data/view.h"
+
+namespace PatternTree
+{
+
+template<typename D>
+struct StencilFunctor {
+
+	/**
+	 * Computes the element of the output at the index from the neighbourhood
+	 * of the index in the input. The neighbourhood covers the rows of the input
+	 * within the radius of the index and is indexed like the input data.
+	 */
+	virtual void operator () (const int index, View<D>& neighbourhood, View<D>& element) = 0;
+	virtual void consumes(Dataflow& dataflow) {};
+
+	virtual bool touch(const int index, PatternIndexInfo &info) { return false; };
+};
+
+template<typename T, typename D>
+concept STENCILFUNCTOR = (std::is_base_of<StencilFunctor<D>, T>::value);
+
+/**
+ * Map over the rows of the output, where each row reads only the rows of the
+ * input within a fixed radius. Splits of the pattern therefore consume their
+ * range of the input plus a halo of radius rows on both sides.
+ * Input and output must be distinct data, since splits read the halo of their
+ * neighbours while these write their rows.
+ */
+template<typename D>
+class Stencil : public IPattern {
+
+std::unique_ptr<StencilFunctor<D>> func_;
+std::shared_ptr<View<D>> input_;
+std::shared_ptr<View<D>> output_;
+int radius_;
+
+template<typename Functor>
+static Dataflow in_data(Functor& functor, std::shared_ptr<IView> input)
+{
+	Dataflow data;
+	data.push_back(input);
+	functor.consumes(data);
+
+	return data;
+};
+
+/**
+ * Reports input and output of the same data, which concurrent splits would read and write.
+ */
+static bool aliased(std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output)
+{
+	if (input->data().lock() == output->data().lock())
+	{
+		// ERROR
+		std::cout << "Error: Input and output of a stencil must be distinct data" << std::endl;
+		return true;
+	}
+
+	return false;
+};
+
+static Dataflow out_data(std::shared_ptr<IView> output)
+{
+	Dataflow data;
+	data.push_back(output);
+
+	return data;
+};
+
+/**
+ * Rows of the input within the radius of the index, clamped to the input data.
+ */
+std::shared_ptr<View<D>> neighbourhood(std::shared_ptr<Data<D>> data, const int index) const
+{
+	int row = this->input_->begins()[0] + index;
+	int begin = std::max(row - this->radius_, 0);
+	int end = std::min(row + this->radius_ + 1, data->shape()[0]);
+
+	if constexpr (ONEDIM<D>) {
+		return View<D>::slice(data, std::make_pair(begin, end));
+	} else {
+		return View<D>::slice(data, std::make_pair(begin, end), std::make_pair(0, data->shape()[1]));
+	}
+};
+
+/**
+ * Touches equidistant rows of the output and refines the interpolation between them.
+ */
+void gather(size_t interpolation_frequency)
+{
+	this->interpolation_frequency_ = interpolation_frequency;
+	std::vector<int> shape = this->output_->shape();
+	size_t interpolation_width = std::max(shape[0] / interpolation_frequency, (size_t) 1);
+	for (size_t i = 0; i < shape[0]; i = i + interpolation_width)
+	{
+		this->touch(i);
+	}
+	this->touch(shape[0] - 1);
+	this->refine(interpolation_frequency);
+};
+
+public:
+	Stencil(std::string identifier, std::unique_ptr<StencilFunctor<D>> func, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius, Dataflow in_data, Dataflow out_data)
+	: 	IPattern(identifier, std::move(in_data), std::move(out_data), output->shape().at(0)),
+		func_(std::move(func)),
+		input_(input),
+		output_(output),
+		radius_(radius)
+	{};
+
+	int radius() const
+	{
+		return this->radius_;
+	};
+
+	const std::type_info& functor() const override
+	{
+		return typeid(*(this->func_));
+	};
+
+	std::shared_ptr<PatternTree::IView> subflow_out(const int index) override {
+		int row = this->output_->begins()[0] + index;
+		return View<D>::element(this->output_->data(), row);
+	};
+
+	void touch(const int index) override
+	{
+			std::shared_ptr<Data<D>> input = std::static_pointer_cast<Data<D>>(this->input_->data().lock());
+			std::shared_ptr<View<D>> neighbourhood = this->neighbourhood(input, index);
+
+			// Option A: Call overriden touch function
+			PatternIndexInfo stats;
+			stats.index = index;
+			if (this->func_->touch(index, stats)) {
+				stats.subviews[input.get()] = neighbourhood;
+				this->info_[index] = std::move(stats);
+				return;
+			}
+
+			// Option B: Execute actual function
+			// - counts flops of the element
+			// - counts bytes accessed on the neighbourhood as read and on the element as written
+			// - subview of the input is the neighbourhood
+			std::shared_ptr<Data<D>> output = std::static_pointer_cast<Data<D>>(this->output_->data().lock());
+			std::shared_ptr<View<D>> element = View<D>::element(output, this->output_->begins()[0] + index);
+
+			neighbourhood->record_accesses();
+			element->record_accesses();
+			element->set_nested_context(true);
+			element->reset_FLOPS();
+			func_.get()->operator()(index, *neighbourhood, *element);
+			element->set_nested_context(false);
+			neighbourhood->accessed();
+			element->accessed();
+
+			stats.flops = element->reset_FLOPS();
+			stats.bytes_read = neighbourhood->accessed_bytes();
+			stats.bytes_written = element->accessed_bytes();
+			stats.subviews[input.get()] = neighbourhood;
+			this->info_[index] = std::move(stats);
+	};
+
+	void execute(const size_t begin, const size_t end) override
+	{
+		std::shared_ptr<Data<D>> input = std::static_pointer_cast<Data<D>>(this->input_->data().lock());
+		std::shared_ptr<Data<D>> output = std::static_pointer_cast<Data<D>>(this->output_->data().lock());
+		StencilFunctor<D>* func = this->func_.get();
+		int input_begin = this->input_->begins()[0];
+		int output_begin = this->output_->begins()[0];
+		int input_rows = input->shape()[0];
+		int radius = this->radius_;
+		int dim1 = output->shape().back();
+
+		Kokkos::parallel_for("PatternTree::Stencil", Kokkos::RangePolicy<Kokkos::DefaultHostExecutionSpace>(begin, end), [=](const int index) {
+			int row = input_begin + index;
+			std::pair<int, int> rows = std::make_pair(std::max(row - radius, 0), std::min(row + radius + 1, input_rows));
+			if constexpr (ONEDIM<D>) {
+				View<D> neighbourhood(input, rows);
+				View<D> element(output, std::make_pair(output_begin + index, output_begin + index + 1));
+				func->operator()(index, neighbourhood, element);
+			} else {
+				View<D> neighbourhood(input, rows, std::make_pair(0, input->shape()[1]));
+				View<D> element(output, std::make_pair(output_begin + index, output_begin + index + 1), std::make_pair(0, dim1));
+				func->operator()(index, neighbourhood, element);
+			}
+		});
+	};
+
+	template<typename Functor>
+	static std::unique_ptr<Stencil<D>> create(std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius, size_t interpolation_frequency) requires STENCILFUNCTOR<Functor, D>
+	{
+		if (aliased(input, output)) { return nullptr; }
+
+		Dataflow in_flow = in_data(*functor, input);
+		Dataflow out_flow = out_data(output);
+		std::unique_ptr<Stencil<D>> stencil(new Stencil<D>(identifier, std::move(functor), input, output, std::max(radius, 0), in_flow, out_flow));
+		stencil->gather(interpolation_frequency);
+
+		return stencil;
+	};
+
+	/**
+	 * Creates the stencil in memory of the allocator, e.g. the arena of an APT.
+	 * Returns nullptr, if input and output are the same data.
+	 */
+	template<typename Functor, typename Allocator>
+	static std::shared_ptr<Stencil<D>> create(const Allocator& allocator, std::string identifier, std::unique_ptr<Functor> functor, std::shared_ptr<View<D>> input, std::shared_ptr<View<D>> output, int radius, size_t interpolation_frequency) requires STENCILFUNCTOR<Functor, D>
+	{
+		if (aliased(input, output)) { return nullptr; }
+
+		Dataflow in_flow = in_data(*functor, input);
+		Dataflow out_flow = out_data(output);
+		std::shared_ptr<Stencil<D>> stencil = std::allocate_shared<Stencil<D>>(allocator, identifier, std::move(functor), input, output, std::max(radius, 0), std::move(in_flow), std::move(out_flow));
+		stencil->gather(interpolation_frequency);
+
+		return stencil;
+	};
+
+};
+
+}
@@ -0,0 +1,77 @@
+#include "touch_cache.h"
+
+PatternTree::TouchCache::TouchCache()
+: mutex_(), infos_()
+{};
+
+PatternTree::TouchCache& PatternTree::TouchCache::instance()
+{
+    static PatternTree::TouchCache cache;
+    return cache;
+};
+
+std::string PatternTree::TouchCache::key(const std::type_info& functor, const PatternTree::Dataflow& consumed)
+{
+    std::string key = functor.name();
+    for (auto const& view : consumed)
+    {
+        key += "|";
+        for (int dim : view->shape())
+        {
+            key += std::to_string(dim) + ",";
+        }
+    }
+
+    return key;
+};
+
+bool PatternTree::TouchCache::find(const std::string& key, const std::vector<int>& indices, std::map<int, PatternTree::PatternIndexInfo>& infos)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    auto entry = this->infos_.find(key);
+    if (entry == this->infos_.end()) {
+        return false;
+    }
+
+    for (int index : indices)
+    {
+        if (entry->second.find(index) == entry->second.end()) {
+            return false;
+        }
+    }
+
+    for (int index : indices)
+    {
+        infos[index] = entry->second.at(index);
+    }
+
+    return true;
+};
+
+void PatternTree::TouchCache::insert(const std::string& key, const std::map<int, PatternTree::PatternIndexInfo>& infos)
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    std::map<int, PatternTree::PatternIndexInfo>& cached = this->infos_[key];
+    for (auto const& info : infos)
+    {
+        if (info.second.subviews.size() > 0) {
+            continue;
+        }
+
+        cached[info.first] = info.second;
+    }
+};
+
+size_t PatternTree::TouchCache::size()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->infos_.size();
+};
+
+void PatternTree::TouchCache::clear()
+{
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->infos_.clear();
+};
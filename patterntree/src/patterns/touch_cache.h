@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+#include "patterns/pattern.h"
+
+namespace PatternTree
+{
+
+/**
+ * Process-wide cache of the info gathered when touching the indices of patterns.
+ * Patterns, whose functors are of the same type and whose consumed views have the
+ * same shapes, share the info of their indices. Only functors declaring their touch
+ * as memoizable are cached. Infos with subviews are never cached, since subviews
+ * refer to the data of a single pattern.
+ */
+class TouchCache {
+
+std::mutex mutex_;
+std::unordered_map<std::string, std::map<int, PatternIndexInfo>> infos_;
+
+TouchCache();
+
+public:
+    static TouchCache& instance();
+
+    /**
+     * Key of a pattern in the cache.
+     *
+     * @param functor type of the functor
+     * @param consumed views consumed by the pattern
+     * @return key
+     */
+    static std::string key(const std::type_info& functor, const Dataflow& consumed);
+
+    /**
+     * Copies the cached infos of the indices into the infos.
+     *
+     * @param key
+     * @param indices
+     * @param infos
+     * @return true, if all indices are cached
+     */
+    bool find(const std::string& key, const std::vector<int>& indices, std::map<int, PatternIndexInfo>& infos);
+
+    void insert(const std::string& key, const std::map<int, PatternIndexInfo>& infos);
+
+    size_t size();
+    void clear();
+};
+
+}
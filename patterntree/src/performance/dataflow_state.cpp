@@ -1,7 +1,9 @@
 #include "dataflow_state.h"
 
+#include <algorithm>
+
 PatternTree::DataflowState::DataflowState()
-: index_(0), table_(), reverse_table_()
+: index_(0), processors_(), processor_ids_(), words_(1), table_(), journal_(), marks_(0)
 {};
 
 size_t PatternTree::DataflowState::index() const
@@ -9,49 +11,106 @@ size_t PatternTree::DataflowState::index() const
     return this->index_;
 };
 
-void PatternTree::DataflowState::reads(const PatternTree::Processor& processor, PatternTree::IView& view)
+size_t PatternTree::DataflowState::processor_id(const PatternTree::Processor& processor)
 {
-    for (auto const& basis_view : IView::as_basis(view))
+    auto it = this->processor_ids_.find(&processor);
+    if (it != this->processor_ids_.end())
     {
-        this->table_.insert({basis_view, &processor});
-        this->reverse_table_.insert({&processor, basis_view});
+        return it->second;
+    }
+
+    size_t id = this->processors_.size();
+    this->processors_.push_back(&processor);
+    this->processor_ids_.insert({&processor, id});
+
+    // Widen the masks of all tables
+    if (this->processors_.size() > this->words_ * 64)
+    {
+        size_t words = this->words_ + 1;
+        for (auto& entry : this->table_)
+        {
+            std::vector<uint64_t>& table = entry.second;
+            size_t blocks = table.size() / this->words_;
+
+            std::vector<uint64_t> widened(blocks * words, 0);
+            for (size_t block = 0; block < blocks; block++)
+            {
+                std::copy(table.begin() + block * this->words_, table.begin() + (block + 1) * this->words_, widened.begin() + block * words);
+            }
+            table = std::move(widened);
+        }
+        for (auto& change : this->journal_)
+        {
+            change.offset = (change.offset / this->words_) * words + change.offset % this->words_;
+        }
+        this->words_ = words;
     }
+
+    return id;
 };
 
-void PatternTree::DataflowState::writes(const PatternTree::Processor& processor, PatternTree::IView& view)
+std::vector<uint64_t>& PatternTree::DataflowState::owners(const PatternTree::IData& data)
 {
-    for (auto const& basis_view : IView::as_basis(view))
+    auto& table = this->table_[&data];
+    if (table.size() == 0)
     {
-        auto range = this->table_.equal_range(basis_view);
-        for (auto it = range.first; it != range.second;) {
-            const PatternTree::Processor* temp = it->second;
-            auto team_range = this->reverse_table_.equal_range(temp);
-            for (auto team_it = team_range.first; team_it != team_range.second; ++team_it) {
-                if (team_it->second == basis_view)
-                {
-                    this->reverse_table_.erase(team_it);
-                    break;
-                }
-            }
+        table.resize(data.basis().size() * this->words_, 0);
+    }
+
+    return table;
+};
 
-            it = this->table_.erase(it);
+void PatternTree::DataflowState::reads(const PatternTree::Processor& processor, PatternTree::IView& view)
+{
+    size_t id = this->processor_id(processor);
+    size_t word = id / 64;
+    uint64_t bit = uint64_t(1) << (id % 64);
+
+    auto data = view.data().lock();
+    std::vector<uint64_t>& table = this->owners(*data);
+    IView::for_each_basis(view, [&](size_t basis_id) {
+        size_t offset = basis_id * this->words_ + word;
+        if (this->marks_ > 0 && !(table[offset] & bit))
+        {
+            this->journal_.push_back({ data.get(), offset, table[offset] });
         }
+        table[offset] |= bit;
+    });
+};
 
-        this->table_.insert({basis_view, &processor});
-        this->reverse_table_.insert({&processor, basis_view});
-    }
+void PatternTree::DataflowState::writes(const PatternTree::Processor& processor, PatternTree::IView& view)
+{
+    size_t id = this->processor_id(processor);
+    size_t word = id / 64;
+    uint64_t bit = uint64_t(1) << (id % 64);
+
+    auto data = view.data().lock();
+    std::vector<uint64_t>& table = this->owners(*data);
+    IView::for_each_basis(view, [&](size_t basis_id) {
+        uint64_t* mask = table.data() + basis_id * this->words_;
+        if (this->marks_ > 0)
+        {
+            for (size_t offset = 0; offset < this->words_; offset++)
+            {
+                this->journal_.push_back({ data.get(), basis_id * this->words_ + offset, mask[offset] });
+            }
+        }
+        std::fill(mask, mask + this->words_, 0);
+        mask[word] = bit;
+    });
 };
 
 std::unordered_multimap<std::shared_ptr<PatternTree::IView>, const PatternTree::Processor*> PatternTree::DataflowState::owned_by(PatternTree::IView& view) const
 {
     std::unordered_multimap<std::shared_ptr<PatternTree::IView>, const PatternTree::Processor*> map;
-    for (auto const& basis_view : IView::as_basis(view))
-    {
-        auto range = this->table_.equal_range(basis_view);
-        for (auto it = range.first; it != range.second; ++it) {
-            map.insert({basis_view, it->second});
-        }
-    }
+
+    auto data = view.data().lock();
+    auto const& basis = data->basis();
+    IView::for_each_basis(view, [&](size_t basis_id) {
+        this->owners(*data, basis_id, [&](const PatternTree::Processor* processor) {
+            map.insert({basis[basis_id], processor});
+        });
+    });
 
     return map;
 };
@@ -59,10 +118,27 @@ std::unordered_multimap<std::shared_ptr<PatternTree::IView>, const PatternTree::
 std::set<std::shared_ptr<PatternTree::IView>> PatternTree::DataflowState::owns(const PatternTree::Processor& processor) const
 {
     std::set<std::shared_ptr<PatternTree::IView>> views;
-    auto range = this->reverse_table_.equal_range(&processor);
-    for (auto it = range.first; it != range.second; ++it) {
-        views.insert(it->second);
+
+    auto it = this->processor_ids_.find(&processor);
+    if (it == this->processor_ids_.end())
+    {
+        return views;
+    }
+
+    size_t word = it->second / 64;
+    uint64_t bit = uint64_t(1) << (it->second % 64);
+    for (auto const& entry : this->table_)
+    {
+        auto const& basis = entry.first->basis();
+        for (size_t basis_id = 0; basis_id < basis.size(); basis_id++)
+        {
+            if (entry.second[basis_id * this->words_ + word] & bit)
+            {
+                views.insert(basis[basis_id]);
+            }
+        }
     }
+
     return views;
 };
 
@@ -95,3 +171,27 @@ void PatternTree::DataflowState::update(PatternTree::Step& step)
 
     this->index_++;
 };
+
+void PatternTree::DataflowState::advance(size_t steps)
+{
+    this->index_ += steps;
+};
+
+PatternTree::DataflowState::Mark PatternTree::DataflowState::mark()
+{
+    this->marks_++;
+    return { this->index_, this->journal_.size() };
+};
+
+void PatternTree::DataflowState::undo(const PatternTree::DataflowState::Mark& mark)
+{
+    for (size_t change = this->journal_.size(); change > mark.changes; change--)
+    {
+        const Change& previous = this->journal_[change - 1];
+        this->table_[previous.data][previous.offset] = previous.word;
+    }
+
+    this->journal_.resize(mark.changes);
+    this->index_ = mark.index;
+    this->marks_--;
+};
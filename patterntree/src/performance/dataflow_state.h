@@ -1,5 +1,7 @@
 #pragma once
 
+#include <bit>
+#include <cstdint>
 #include <unordered_map>
 #include <set>
 
@@ -12,20 +14,103 @@ namespace PatternTree
 class DataflowState {
 
 size_t index_;
-std::unordered_multimap<std::shared_ptr<IView>, const Processor*> table_;
-std::unordered_multimap<const Processor*, std::shared_ptr<IView>> reverse_table_;
+
+// Dense ids of the processors seen so far, one bit per processor in the masks
+std::vector<const Processor*> processors_;
+std::unordered_map<const Processor*, size_t> processor_ids_;
+size_t words_;
+
+// Owner masks of each data, words_ words per basis view indexed by basis id
+std::unordered_map<const IData*, std::vector<uint64_t>> table_;
+
+// Previous words of the masks changed since the first open mark
+struct Change
+{
+    const IData* data;
+    size_t offset;
+    uint64_t word;
+};
+std::vector<Change> journal_;
+size_t marks_;
+
+size_t processor_id(const Processor& processor);
+std::vector<uint64_t>& owners(const IData& data);
 
 void reads(const Processor& processor, IView& view);
 void writes(const Processor& processor, IView& view);
 
 public:
+
+    /**
+     * Position of the state, which the state can be reverted to.
+     */
+    struct Mark
+    {
+        size_t index;
+        size_t changes;
+    };
+
     DataflowState();
 
     size_t index() const;
     std::unordered_multimap<std::shared_ptr<IView>, const Processor*> owned_by(IView& view) const;
     std::set<std::shared_ptr<IView>> owns(const Processor& processor) const;
 
+    /**
+     * Calls the function with each processor owning the basis view of the data.
+     * Does not allocate.
+     *
+     * @param data
+     * @param basis_id
+     * @param func
+     */
+    template<typename F>
+    void owners(const IData& data, size_t basis_id, F func) const
+    {
+        auto table = this->table_.find(&data);
+        if (table == this->table_.end())
+        {
+            return;
+        }
+
+        const uint64_t* mask = table->second.data() + basis_id * this->words_;
+        for (size_t word = 0; word < this->words_; word++)
+        {
+            uint64_t bits = mask[word];
+            while (bits != 0)
+            {
+                size_t bit = std::countr_zero(bits);
+                func(this->processors_[word * 64 + bit]);
+                bits &= bits - 1;
+            }
+        }
+    };
+
     void update(Step& step);
+
+    /**
+     * Advances the state over steps, which leave the owners unchanged, e.g. further
+     * repetitions of the steps of a loop in its steady state.
+     *
+     * @param steps
+     */
+    void advance(size_t steps);
+
+    /**
+     * Starts recording the changes of the owners, such that undo reverts them in the
+     * number of changed words instead of copying the state. Marks nest.
+     *
+     * @return mark
+     */
+    Mark mark();
+
+    /**
+     * Reverts the owners and the index to the mark and closes the mark.
+     * Marks opened after the mark must be closed before.
+     *
+     * @param mark
+     */
+    void undo(const Mark& mark);
 };
 
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <nlohmann/json.hpp>
 
 namespace PatternTree
@@ -29,6 +31,25 @@ public:
          */
         virtual void update(Step& step) = 0;
 
+        /**
+         * Updates state of cost estimation with further repetitions of the last steps,
+         * e.g. the period of a loop of the APT, whose mapping repeats. By default, the
+         * steps are updated again for each repetition.
+         *
+         * @param steps last steps passed to update
+         * @param trips number of repetitions
+         */
+        virtual void repeat(const std::vector<Step*>& steps, size_t trips)
+        {
+                for (size_t trip = 0; trip < trips; trip++)
+                {
+                        for (Step* step : steps)
+                        {
+                                this->update(*step);
+                        }
+                }
+        };
+
         /**
          * Report of cost estimation as json.
          * 
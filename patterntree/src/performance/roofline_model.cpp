@@ -3,15 +3,25 @@
 #include <limits>
 #include <algorithm>
 #include <functional>
+#include <tuple>
 
 #include "cluster/cluster.h"
 
 using json = nlohmann::json;
 
 PatternTree::RooflineModel::RooflineModel()
-: current_costs_(0), state_(), costs_(), max_costs_()
+: RooflineModel(Variant::SCALAR)
 {};
 
+PatternTree::RooflineModel::RooflineModel(PatternTree::RooflineModel::Variant variant)
+: variant_(variant), state_(), current_costs_(0), steps_(), costs_(), max_costs_(), combine_costs_(), repeated_steps_(0)
+{};
+
+PatternTree::RooflineModel::Variant PatternTree::RooflineModel::variant() const
+{
+   return this->variant_;
+};
+
 double PatternTree::RooflineModel::costs()
 {
    return this->current_costs_;
@@ -23,13 +33,19 @@ void PatternTree::RooflineModel::update(PatternTree::Step& step)
    double max_exec_costs = 0.0;
    double max_net_costs = 0.0;
 
-   std::unordered_map<const Team*, std::pair<double, double>> step_costs;
+   std::vector<Splits> groups;
+   std::vector<const Team*> teams;
    for (auto const& team : step.teams()) {
-      auto patterns = step.assigned(*team);
+      groups.push_back(step.assigned(*team));
+      teams.push_back(team.get());
+   }
 
-      double exec_costs = this->execution_costs(patterns, *team);
-      double net_costs = this->network_costs(patterns, *team);
-      double total_costs = (1.0 - std::min(net_costs / exec_costs, ROOFLINE_OVERLAP)) * exec_costs + net_costs;
+   std::unordered_map<const Team*, std::pair<double, double>> step_costs;
+   auto team_costs = this->step_costs(groups, teams);
+   for (size_t i = 0; i < teams.size(); i++) {
+      double exec_costs = team_costs[i].first;
+      double net_costs = team_costs[i].second;
+      double total_costs = this->overlap(exec_costs, net_costs);
 
       if (total_costs > max_costs) {
             max_costs = total_costs;
@@ -37,21 +53,163 @@ void PatternTree::RooflineModel::update(PatternTree::Step& step)
             max_net_costs = net_costs;
       }
 
-      step_costs.insert({team.get(), std::make_pair(exec_costs, net_costs)});
+      step_costs.insert({teams[i], std::make_pair(exec_costs, net_costs)});
    }
 
+   // Partial results of reductions split across teams are combined after the step
+   double combine_costs = 0.0;
+   for (auto it = step.begin(); it != step.end(); ++it) {
+      auto reduce = dynamic_cast<const PatternTree::IReduce*>(&(*it));
+      if (reduce == nullptr) { continue; }
+
+      std::vector<const PatternTree::Team*> teams;
+      for (auto const& team : step.teams(*it)) {
+         teams.push_back(team.get());
+      }
+      combine_costs += this->combine_costs(*reduce, teams);
+   }
+
+   this->steps_.push_back(step.index());
    this->costs_.push_back(step_costs);
    this->max_costs_.push_back(std::make_pair(max_exec_costs, max_net_costs));
-   this->current_costs_ += max_costs;
+   this->combine_costs_.push_back(combine_costs);
+   this->current_costs_ += max_costs + combine_costs;
 
    this->state_.update(step);
 };
 
+void PatternTree::RooflineModel::repeat(const std::vector<PatternTree::Step*>& steps, size_t trips)
+{
+   size_t size = std::min(steps.size(), this->costs_.size());
+
+   double period_costs = 0.0;
+   for (size_t i = this->costs_.size() - size; i < this->costs_.size(); i++) {
+      period_costs += this->overlap(this->max_costs_[i].first, this->max_costs_[i].second) + this->combine_costs_[i];
+   }
+
+   this->current_costs_ += trips * period_costs;
+   this->repeated_steps_ += trips * size;
+   this->state_.advance(trips * size);
+};
+
+double PatternTree::RooflineModel::overlap(double exec_costs, double net_costs) const
+{
+   double max_overlap = this->variant_ == Variant::PEAK ? PEAK_OVERLAP : ROOFLINE_OVERLAP;
+   double overlap = exec_costs > 0.0 ? std::min(net_costs / exec_costs, max_overlap) : 0.0;
+   return (1.0 - overlap) * exec_costs + net_costs;
+};
+
+double PatternTree::RooflineModel::costs(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team) const
+{
+   double exec_costs = this->execution_costs(splits, team);
+   double net_costs = this->network_costs(splits, team);
+   return this->overlap(exec_costs, net_costs);
+};
+
+std::vector<double> PatternTree::RooflineModel::costs(const std::vector<Splits>& groups, const std::vector<const PatternTree::Team*>& teams) const
+{
+   std::vector<double> costs;
+   for (auto const& team_costs : this->step_costs(groups, teams))
+   {
+      costs.push_back(this->overlap(team_costs.first, team_costs.second));
+   }
+
+   return costs;
+};
+
+std::vector<std::pair<double, double>> PatternTree::RooflineModel::step_costs(const std::vector<Splits>& groups, const std::vector<const PatternTree::Team*>& teams) const
+{
+   std::vector<Transfers> transfers;
+   for (size_t i = 0; i < teams.size(); i++)
+   {
+      transfers.push_back(this->transfers(groups[i], *(teams[i])));
+   }
+
+   // Teams of the step pull their data concurrently and share the links of the cluster
+   LinkLoads loads = this->link_loads(transfers, teams);
+
+   std::vector<std::pair<double, double>> costs;
+   for (size_t i = 0; i < teams.size(); i++)
+   {
+      double exec_costs = this->execution_costs(groups[i], *(teams[i]));
+      double net_costs = this->network_costs(transfers[i], *(teams[i]), &loads);
+      costs.push_back(std::make_pair(exec_costs, net_costs));
+   }
+
+   return costs;
+};
+
+PatternTree::RooflineModel::Checkpoint PatternTree::RooflineModel::checkpoint() const
+{
+   return { this->state_, this->current_costs_, this->costs_.size(), this->repeated_steps_ };
+};
+
+void PatternTree::RooflineModel::rollback(const PatternTree::RooflineModel::Checkpoint& checkpoint)
+{
+   this->state_ = checkpoint.state;
+   this->current_costs_ = checkpoint.costs;
+   this->repeated_steps_ = checkpoint.repeated_steps;
+   this->truncate(checkpoint.steps);
+};
+
+void PatternTree::RooflineModel::truncate(size_t steps)
+{
+   this->steps_.resize(steps);
+   this->costs_.resize(steps);
+   this->max_costs_.resize(steps);
+   this->combine_costs_.resize(steps);
+};
+
+double PatternTree::RooflineModel::evaluate(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end)
+{
+   return this->evaluate(begin, end, std::numeric_limits<size_t>::max());
+};
+
+double PatternTree::RooflineModel::evaluate(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end, size_t window)
+{
+   auto mark = this->state_.mark();
+   double previous_costs = this->current_costs_;
+   size_t steps = this->costs_.size();
+
+   size_t count = 0;
+   for (auto iter = begin; iter != end && count < window; iter++, count++)
+   {
+      this->update(*iter);
+   }
+   double costs = this->current_costs_ - previous_costs;
+
+   this->state_.undo(mark);
+   this->current_costs_ = previous_costs;
+   this->truncate(steps);
+   return costs;
+};
+
+double PatternTree::RooflineModel::evaluate_delta(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end, const PatternTree::PatternSplit& split, std::shared_ptr<PatternTree::Team> team, size_t window)
+{
+   PatternTree::Step& step = *begin;
+   auto previous = step.assigned(split);
+
+   double costs = this->evaluate(begin, end, window);
+
+   step.assign(split, team);
+   double delta = this->evaluate(begin, end, window) - costs;
+
+   if (previous.has_value()) {
+      step.assign(split, previous.value());
+   } else {
+      step.free(split);
+   }
+
+   return delta;
+};
+
 json PatternTree::RooflineModel::report()
 {
    json report = json::object();
-   report["steps"] = this->costs_.size();
+   report["steps"] = this->costs_.size() + this->repeated_steps_;
+   report["repeated-steps"] = this->repeated_steps_;
    report["costs"] = this->current_costs_;
+   report["variant"] = this->variant_ == Variant::PEAK ? "peak" : "scalar";
    
    json steps = json::array();
    for (size_t i = 0; i < this->costs_.size(); i++) {
@@ -59,8 +217,9 @@ json PatternTree::RooflineModel::report()
       auto max_costs = this->max_costs_.at(i);
 
       json step = json::object();
-      step["step"] = i;
+      step["step"] = this->steps_.at(i);
       step["max_costs"] = { max_costs.first, max_costs.second };
+      step["combine_costs"] = this->combine_costs_.at(i);
 
       json teams = json::array();
       for (auto const& it : costs) {
@@ -80,152 +239,254 @@ json PatternTree::RooflineModel::report()
    return report;
 }
 
-double PatternTree::RooflineModel::execution_costs(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team)
+double PatternTree::RooflineModel::peak_flops(const PatternTree::Processor& processor, int cores) const
+{
+   double peak_flops = cores * processor.frequency() * FREQUENCY_TO_SECONDS;
+   if (this->variant_ == Variant::PEAK) {
+      peak_flops *= processor.arithmetic_units() * processor.vector_width();
+      peak_flops *= processor.fma() ? 2 : 1;
+   }
+
+   return peak_flops;
+};
+
+double PatternTree::RooflineModel::execution_costs(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team) const
 {
    double total_costs = 0.0;
    for (auto const& split : splits)
    {
       if ( split.get().width() == 0) { continue; } 
 
-      double flops = split.get().flops();
       int width = split.get().width();
-      
-      double costs = flops;
-      costs /= std::min(width, team.cores());
-      //costs /= team.processor().arithmetic_units();
-      costs /= team.processor().frequency() * FREQUENCY_TO_SECONDS;
+      int cores = std::min(width, team.cores());
+
+      double peak_flops = this->peak_flops(team.processor(), cores);
+
+      // Bytes per second from the memory of the device, saturating at its maximum bandwidth
+      auto const& device = team.processor().device();
+      double bandwidth = std::min(cores * device.memory_bandwidth(), device.memory_max_bandwidth()) * BANDWIDTH_TO_SECONDS * 1000.0;
+
+      // Roofline: below the ridge point, the split is bound by the bandwidth
+      double compute_costs = split.get().flops() / peak_flops;
+      double memory_costs = split.get().bytes() / bandwidth;
 
-      total_costs += costs;
+      total_costs += std::max(compute_costs, memory_costs);
    }
 
    return total_costs;
 };
 
-double PatternTree::RooflineModel::network_costs(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team)
+double PatternTree::RooflineModel::network_costs(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team) const
+{
+   return this->network_costs(this->transfers(splits, team), team, nullptr);
+};
+
+PatternTree::RooflineModel::Transfers PatternTree::RooflineModel::transfers(const std::vector<std::reference_wrapper<const PatternTree::PatternSplit>>& splits, const PatternTree::Team& team) const
 {
    double initial_kbytes = 0;
    std::map<const PatternTree::Processor*, double> kbytes_transfer_table;
    
-   std::unordered_set<std::shared_ptr<PatternTree::IView>> basis_views;
+   // Basis views already accounted for, per data
+   std::unordered_map<const PatternTree::IData*, std::vector<bool>> visited;
+   std::vector<const PatternTree::Processor*> processors;
    for (auto const& split : splits)
    {
       for (auto const& view : split.get().consumes())
       {
-         auto bvs = PatternTree::IView::as_basis(*view);
-         basis_views.insert(bvs.begin(), bvs.end());
+         auto data = view->data().lock();
+         auto const& basis = data->basis();
+
+         std::vector<bool>& seen = visited[data.get()];
+         if (seen.size() == 0) {
+            seen.resize(basis.size(), false);
+         }
+
+         PatternTree::IView::for_each_basis(*view, [&](size_t id) {
+            if (seen[id]) {
+               return;
+            }
+            seen[id] = true;
+
+            double kbytes = basis[id]->kbytes();
+
+            processors.clear();
+            this->state_.owners(*data, id, [&](const PatternTree::Processor* processor) {
+               processors.push_back(processor);
+            });
+
+            if (processors.size() == 0) {
+               initial_kbytes += kbytes;
+            } else {
+               const PatternTree::Processor* closest = &PatternTree::Cluster::closest(team.processor(), processors);  
+               if (kbytes_transfer_table.find(closest) != kbytes_transfer_table.end()) {
+                  kbytes += kbytes_transfer_table[closest];
+               }
+               kbytes_transfer_table[closest] = kbytes;
+            }
+         });
       }
    }
 
-   for (auto const& basis_view : basis_views)
-   {
-      auto owners = this->state_.owned_by(*basis_view);
-      double kbytes = basis_view->kbytes();
-      auto range = owners.equal_range(basis_view);
+   return { initial_kbytes, kbytes_transfer_table };
+};
 
-      if (range.first == owners.end()) {
-         initial_kbytes += kbytes;
-      } else {
-         std::vector<const PatternTree::Processor*> processors;
-         for (auto it = range.first; it != range.second; it++)
-         {
-            processors.push_back(it->second);
+PatternTree::RooflineModel::LinkLoads PatternTree::RooflineModel::link_loads(const std::vector<Transfers>& transfers, const std::vector<const PatternTree::Team*>& teams) const
+{
+   LinkLoads loads;
+   for (size_t i = 0; i < teams.size(); i++)
+   {
+      for (auto const& entry : transfers[i].kbytes)
+      {
+         if (PatternTree::Cluster::distance(*entry.first, teams[i]->processor()) != PatternTree::Cluster::Distance::CLUSTER) {
+            continue;
          }
 
-         const PatternTree::Processor* closest = &PatternTree::Cluster::closest(team.processor(), processors);  
-         if (kbytes_transfer_table.find(closest) != kbytes_transfer_table.end()) {
-            kbytes += kbytes_transfer_table[closest];
+         auto const& target = teams[i]->processor().device().node();
+         for (auto const& link : target.cluster().route(entry.first->device().node(), target))
+         {
+            loads[link]++;
          }
-         kbytes_transfer_table[closest] = kbytes;
       }
    }
 
+   return loads;
+};
+
+double PatternTree::RooflineModel::network_costs(const PatternTree::RooflineModel::Transfers& transfers, const PatternTree::Team& team, const LinkLoads* loads) const
+{
    double total_costs = 0.0;
-   if (initial_kbytes > 0.0) {
+   if (transfers.initial_kbytes > 0.0) {
       double bandwidth;
       double latency;
       if (team.processor().device().type() == "CPU") {
          bandwidth = std::min(team.cores() * team.processor().device().memory_bandwidth(), team.processor().device().memory_max_bandwidth());
          latency = team.processor().device().memory_latency();
       } else {
-         auto device = team.processor().device();
-         auto node = device.node();
+         auto const& device = team.processor().device();
+         auto const& node = device.node();
          auto cpu = node.devices().find("CPU1")->second;
          bandwidth = node.bandwidth(*cpu, device);
          latency = node.latency(*cpu, device);
       }
 
       total_costs += (latency / LATENCY_TO_SECONDS);
-      total_costs += initial_kbytes / (bandwidth * BANDWIDTH_TO_SECONDS);
+      total_costs += transfers.initial_kbytes / (bandwidth * BANDWIDTH_TO_SECONDS);
    }
 
-   for (auto const& entry : kbytes_transfer_table)
+   for (auto const& entry : transfers.kbytes)
    {
-      auto dist = PatternTree::Cluster::distance(*entry.first, team.processor());
-      switch (dist)
-      {
-      case PatternTree::Cluster::Distance::PROCESSOR:
-      {
-         double cache_bandwidth = team.cores() * team.processor().cache_bandwidth();
-         double cache_latency = team.processor().cache_latency();
+      total_costs += this->transfer_costs(*entry.first, team, entry.second, loads);
+   }
 
-         double cached_kbytes = std::min(entry.second, team.processor().cache_size() * 1000.0);
-         double main_kbytes = entry.second - cached_kbytes;
+   return total_costs;
+};
+
+double PatternTree::RooflineModel::transfer_costs(const PatternTree::Processor& source, const PatternTree::Team& team, double kbytes, const LinkLoads* loads) const
+{
+   auto dist = PatternTree::Cluster::distance(source, team.processor());
+   switch (dist)
+   {
+   case PatternTree::Cluster::Distance::PROCESSOR:
+   {
+      double cache_bandwidth = team.cores() * team.processor().cache_bandwidth();
+      double cache_latency = team.processor().cache_latency();
 
-         double costs = cache_latency / LATENCY_TO_SECONDS;
-         costs += cached_kbytes / (cache_bandwidth * BANDWIDTH_TO_SECONDS);
-         if (main_kbytes > 0.0) {
-            auto device = team.processor().device();
-            double main_bandwidth = std::min(team.cores() * device.memory_bandwidth(), device.memory_max_bandwidth());
-            double main_latency = device.memory_latency();
+      double cached_kbytes = std::min(kbytes, team.processor().cache_size() * 1000.0);
+      double main_kbytes = kbytes - cached_kbytes;
 
-            double main_costs = main_kbytes / (main_bandwidth * BANDWIDTH_TO_SECONDS);
-            main_costs += main_latency / LATENCY_TO_SECONDS;
+      double costs = cache_latency / LATENCY_TO_SECONDS;
+      costs += cached_kbytes / (cache_bandwidth * BANDWIDTH_TO_SECONDS);
+      if (main_kbytes > 0.0) {
+         auto const& device = team.processor().device();
+         double main_bandwidth = std::min(team.cores() * device.memory_bandwidth(), device.memory_max_bandwidth());
+         double main_latency = device.memory_latency();
 
-            costs = std::max(costs, main_costs);
-         }
+         double main_costs = main_kbytes / (main_bandwidth * BANDWIDTH_TO_SECONDS);
+         main_costs += main_latency / LATENCY_TO_SECONDS;
 
-         total_costs += costs;
-         break;
+         costs = std::max(costs, main_costs);
       }
-      case PatternTree::Cluster::Distance::DEVICE:
-      {
-         auto device = team.processor().device();
-         double bandwidth = std::min(team.cores() * device.memory_bandwidth(), device.memory_max_bandwidth());
-         double latency = device.memory_latency();
 
-         double costs = latency / LATENCY_TO_SECONDS;
-         costs += entry.second / (bandwidth * BANDWIDTH_TO_SECONDS);
+      return costs;
+   }
+   case PatternTree::Cluster::Distance::DEVICE:
+   {
+      auto const& device = team.processor().device();
+      double bandwidth = std::min(team.cores() * device.memory_bandwidth(), device.memory_max_bandwidth());
+      double latency = device.memory_latency();
 
-         total_costs += costs;
-         break;
+      double costs = latency / LATENCY_TO_SECONDS;
+      costs += kbytes / (bandwidth * BANDWIDTH_TO_SECONDS);
+      return costs;
+   }
+   case PatternTree::Cluster::Distance::CLUSTER:
+   {
+      // Along the route across the cluster, each link is shared by its concurrent transfers
+      auto const& target = team.processor().device().node();
+      auto const& cluster = target.cluster();
+      double bandwidth = cluster.bandwidth(source, team.processor());
+      double latency = cluster.latency(source, team.processor());
+
+      if (loads != nullptr) {
+         for (auto const& link : cluster.route(source.device().node(), target))
+         {
+            auto load = loads->find(link);
+            if (load != loads->end() && load->second > 1) {
+               bandwidth = std::min(bandwidth, cluster.links()[link].bandwidth / load->second);
+            }
+         }
       }
-      case PatternTree::Cluster::Distance::NODE:
-      {
-         auto device = team.processor().device();
-         auto node = device.node();
-         double bandwidth = node.bandwidth(entry.first->device(), device);
-         double latency = node.latency(entry.first->device(), device);
 
-         double costs = latency / LATENCY_TO_SECONDS;
-         costs += entry.second / (bandwidth * BANDWIDTH_TO_SECONDS);
+      double costs = latency / LATENCY_TO_SECONDS;
+      costs += kbytes / (bandwidth * BANDWIDTH_TO_SECONDS);
+      return costs;
+   }
+   default:
+   {
+      // Across devices, through the node
+      auto const& cluster = team.processor().device().node().cluster();
+      double bandwidth = cluster.bandwidth(source, team.processor());
+      double latency = cluster.latency(source, team.processor());
+
+      double costs = latency / LATENCY_TO_SECONDS;
+      costs += kbytes / (bandwidth * BANDWIDTH_TO_SECONDS);
+      return costs;
+   }
+   }
+};
 
-         total_costs += costs;
-         break;
-      }
-      default:
-      {
-         auto node = team.processor().device().node();
-         auto cluster = node.cluster();
-         double bandwidth = cluster.bandwidth(entry.first->device().node(), node);
-         double latency = cluster.latency(entry.first->device().node(), node);
+double PatternTree::RooflineModel::combine_costs(const PatternTree::IReduce& reduce, std::vector<const PatternTree::Team*> teams) const
+{
+   if (teams.size() < 2) {
+      return 0.0;
+   }
 
-         double costs = latency / LATENCY_TO_SECONDS;
-         costs += entry.second / (bandwidth * BANDWIDTH_TO_SECONDS);
+   // Teams on the same node and device become neighbours and are combined in the lower levels
+   std::sort(teams.begin(), teams.end(), [](const PatternTree::Team* a, const PatternTree::Team* b) {
+      auto const& device_a = a->processor().device();
+      auto const& device_b = b->processor().device();
+      return std::make_tuple(device_a.node().identifier(), device_a.identifier(), &(a->processor()), a)
+         < std::make_tuple(device_b.node().identifier(), device_b.identifier(), &(b->processor()), b);
+   });
 
-         total_costs += costs;
-         break;
-      }
+   double kbytes = reduce.partial_kbytes();
+   double flops = reduce.combine_flops();
+
+   // Each level of the tree halves the partial results, the pairs of a level combine concurrently
+   double total_costs = 0.0;
+   for (size_t stride = 1; stride < teams.size(); stride *= 2)
+   {
+      double level_costs = 0.0;
+      for (size_t i = 0; i + stride < teams.size(); i += 2 * stride)
+      {
+         const PatternTree::Team& target = *(teams[i]);
+         double costs = this->transfer_costs(teams[i + stride]->processor(), target, kbytes);
+         costs += flops / (target.processor().frequency() * FREQUENCY_TO_SECONDS);
+
+         level_costs = std::max(level_costs, costs);
       }
+
+      total_costs += level_costs;
    }
 
    return total_costs;
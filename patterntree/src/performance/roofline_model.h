@@ -2,38 +2,151 @@
 
 #include <map>
 
+#include "apt/apt.h"
 #include "apt/step.h"
 #include "performance/dataflow_state.h"
 #include "performance/performance_model.h"
+#include "patterns/reduce.h"
 
 namespace PatternTree
 {
 class RooflineModel : public IPerformanceModel {
+public:
+
+    /**
+     * Ceilings of the model. The scalar model executes a single FLOP per core
+     * and cycle and adds the network costs to the execution costs. The peak model
+     * executes at the peak of the arithmetic units, vector lanes and FMA of the
+     * processor and overlaps network and execution costs completely.
+     */
+    enum class Variant { SCALAR, PEAK };
+
+    typedef std::vector<std::reference_wrapper<const PatternSplit>> Splits;
+
+    /**
+     * Kilobytes transferred to a team, from the main memory of its node and
+     * from the closest processor owning each part of the consumed data.
+     */
+    struct Transfers
+    {
+        double initial_kbytes;
+        std::map<const Processor*, double> kbytes;
+    };
+
+    /**
+     * Number of concurrent transfers on each link of the cluster, by the index of the link.
+     */
+    typedef std::unordered_map<size_t, size_t> LinkLoads;
+
+private:
+    Variant variant_;
     DataflowState state_;
 
     double current_costs_;
+    std::vector<size_t> steps_;
     std::vector<std::unordered_map<const Team*, std::pair<double, double>>> costs_;
     std::vector<std::pair<double, double>> max_costs_;
+    std::vector<double> combine_costs_;
+
+    // Steps estimated as repetitions of previous steps, without costs of their own
+    size_t repeated_steps_;
 
     static constexpr double ROOFLINE_OVERLAP = 0.0;
+    static constexpr double PEAK_OVERLAP = 1.0;
+
+    double overlap(double exec_costs, double net_costs) const;
+
+    // Drops the costs of the steps after the first steps
+    void truncate(size_t steps);
+
+    // Costs of the steps in the window, reverting the state changes of the window
+    double evaluate(APT::Iterator begin, APT::Iterator end, size_t window);
+    std::vector<std::pair<double, double>> step_costs(const std::vector<Splits>& groups, const std::vector<const Team*>& teams) const;
 public:
 
+    /**
+     * Snapshot of the model, which the model can be rolled back to.
+     */
+    struct Checkpoint
+    {
+        DataflowState state;
+        double costs;
+        size_t steps;
+        size_t repeated_steps;
+    };
+
+    // Steps following a reassigned split, whose costs are estimated by default
+    static constexpr size_t DELTA_WINDOW = 8;
+
     RooflineModel();
+    RooflineModel(Variant variant);
+
+    Variant variant() const;
 
     double costs() override;
 
     void update(Step& step) override;
 
+    /**
+     * Adds the costs of the last steps for each repetition. The last steps are expected
+     * to be in the steady state, i.e. their mapping equals the mapping of the steps
+     * before them, such that repeating them leaves the dataflow state unchanged.
+     *
+     * @param steps last steps passed to update
+     * @param trips number of repetitions
+     */
+    void repeat(const std::vector<Step*>& steps, size_t trips) override;
+
     nlohmann::json report() override;
 
+    Checkpoint checkpoint() const;
+    void rollback(const Checkpoint& checkpoint);
+
+    /**
+     * Estimates the costs of the steps following the current state.
+     * The model is left unchanged, the changes of the state are reverted
+     * instead of copying the state.
+     *
+     * @param begin next step of the model
+     * @param end
+     * @return costs
+     */
+    double evaluate(APT::Iterator begin, APT::Iterator end);
+
+    /**
+     * Estimates the change in costs of the window of steps following the current
+     * state when the split of the next step is reassigned to the team. The costs of
+     * the window are estimated for both assignments, the steps after the window
+     * are not estimated. The model and the assignment are left unchanged.
+     *
+     * @param begin next step of the model, which contains the split
+     * @param end
+     * @param split
+     * @param team
+     * @param window maximum number of steps from begin
+     * @return difference in costs to the current assignment
+     */
+    double evaluate_delta(APT::Iterator begin, APT::Iterator end, const PatternSplit& split, std::shared_ptr<Team> team, size_t window = DELTA_WINDOW);
+
+    /**
+     * Peak FLOPS of the cores of the processor.
+     *
+     * @param processor
+     * @param cores
+     * @return flops per second
+     */
+    double peak_flops(const Processor& processor, int cores) const;
+
     /**
      * Estimates the execution costs of the splits with the team.
+     * Each split is bound by the maximum of its FLOPS at the peak of the team
+     * and its bytes at the cache bandwidth of the team.
      *
      * @param splits
      * @param team
      * @return costs
      */
-    double execution_costs(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team);
+    double execution_costs(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team) const;
 
     /**
      * Estimates the network costs of the splits with the team.
@@ -42,7 +155,84 @@ public:
      * @param team
      * @return costs
      */
-    double network_costs(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team);
+    double network_costs(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team) const;
+
+    /**
+     * Estimates the network costs of the transfers to the team, where the
+     * transfers across the cluster share the links with the given loads.
+     *
+     * @param transfers
+     * @param team
+     * @param loads concurrent transfers per link, or null for exclusive links
+     * @return costs
+     */
+    double network_costs(const Transfers& transfers, const Team& team, const LinkLoads* loads) const;
+
+    /**
+     * Collects the transfers of the splits with the team in the current state.
+     *
+     * @param splits
+     * @param team
+     * @return transfers
+     */
+    Transfers transfers(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team) const;
+
+    /**
+     * Counts the transfers across the cluster routed over each link, when
+     * the teams pull their transfers concurrently.
+     *
+     * @param transfers of each team
+     * @param teams
+     * @return loads
+     */
+    LinkLoads link_loads(const std::vector<Transfers>& transfers, const std::vector<const Team*>& teams) const;
+
+    /**
+     * Estimates the costs of the splits with the team, overlapping
+     * execution and network costs.
+     * Does not modify the model and may be called concurrently.
+     *
+     * @param splits
+     * @param team
+     * @return costs
+     */
+    double costs(const std::vector<std::reference_wrapper<const PatternSplit>>& splits, const Team& team) const;
+
+    /**
+     * Estimates the costs of the groups of splits executed concurrently by the
+     * teams of a step. Transfers of the teams routed over the same link of the
+     * cluster share its bandwidth equally.
+     * Does not modify the model and may be called concurrently.
+     *
+     * @param groups of splits, one per team
+     * @param teams
+     * @return costs of each team
+     */
+    std::vector<double> costs(const std::vector<Splits>& groups, const std::vector<const Team*>& teams) const;
+
+    /**
+     * Estimates the costs of transferring data from the source processor
+     * to the team. Across the cluster, the transfer is bound by the link
+     * of its route with the lowest share of bandwidth.
+     *
+     * @param source
+     * @param team
+     * @param kbytes
+     * @param loads concurrent transfers per link, or null for exclusive links
+     * @return costs
+     */
+    double transfer_costs(const Processor& source, const Team& team, double kbytes, const LinkLoads* loads = nullptr) const;
+
+    /**
+     * Estimates the costs of combining the partial results of the reduction
+     * across the teams. The partial results are combined pairwise in a binary
+     * tree, where teams close to each other are combined first.
+     *
+     * @param reduce
+     * @param teams
+     * @return costs
+     */
+    double combine_costs(const IReduce& reduce, std::vector<const Team*> teams) const;
 
 };
 }
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <Kokkos_Core.hpp>
+
 #include "algorithms/jacobi.cpp"
 #include "algorithms/kmeans.cpp"
 #include "algorithms/monte_carlo.cpp"
+#include "algorithms/heat.cpp"
 
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
+    Kokkos::ScopeGuard kokkos(argc, argv);
 
     return RUN_ALL_TESTS();
 }
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <patterns/map.h>
+#include <patterns/stencil.h>
+
+#include <cluster/cluster.h>
+#include <cluster/team.h>
+
+#include <optimization/optimizer.h>
+
+#include <performance/dataflow_state.h>
+#include <performance/roofline_model.h>
+
+struct HeatStencilFunctor : public PatternTree::StencilFunctor<double**> {
+    HeatStencilFunctor(size_t N)
+    : N(N)
+    {}
+
+    void operator () (const int index, PatternTree::View<double**>& u, PatternTree::View<double**>& v) override {
+        if (index == 0 || index == N - 1) { return; }
+
+        for (size_t j = 1; j < N - 1; j++)
+        {
+            v(index, j) = 0.25 * (u(index - 1, j) + u(index + 1, j) + u(index, j - 1) + u(index, j + 1));
+        }
+    };
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        // Loop: Check & increment
+        info.flops = 2 * N;
+        // Sum & scale
+        info.flops += 4 * N;
+        return true;
+    }
+
+private:
+    size_t N;
+};
+
+struct HeatMapFunctor : public PatternTree::MapFunctor<double**> {
+    HeatMapFunctor(size_t N, std::shared_ptr<PatternTree::View<double**>> u)
+    : N(N), u(u)
+    {}
+
+    void operator () (const int index, PatternTree::View<double**>& v) override {
+        if (index == 0 || index == N - 1) { return; }
+
+        for (size_t j = 1; j < N - 1; j++)
+        {
+            v(index, j) = 0.25 * ((*u)(index - 1, j) + (*u)(index + 1, j) + (*u)(index, j - 1) + (*u)(index, j + 1));
+        }
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {
+        dataflow.push_back(u);
+    };
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        // Loop: Check & increment
+        info.flops = 2 * N;
+        // Sum & scale
+        info.flops += 4 * N;
+        return true;
+    }
+
+private:
+    size_t N;
+    std::shared_ptr<PatternTree::View<double**>> u;
+};
+
+std::unique_ptr<PatternTree::APT> heat(size_t N, size_t K, bool stencil)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 64, true);
+
+    auto u = PatternTree::APT::source<double**>("u", N, N);
+    auto v = PatternTree::APT::source<double**>("v", N, N);
+
+    for (size_t k = 0; k < K; k++)
+    {
+        if (stencil) {
+            std::unique_ptr<HeatStencilFunctor> functor(new HeatStencilFunctor(N));
+            PatternTree::APT::stencil<double**, HeatStencilFunctor>("heat", std::move(functor), u, v, 1);
+        } else {
+            std::unique_ptr<HeatMapFunctor> functor(new HeatMapFunctor(N, u));
+            PatternTree::APT::map<double**, HeatMapFunctor>("heat", std::move(functor), v);
+        }
+
+        u.swap(v);
+    }
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    return std::move(apt);
+};
+
+class HeatMappingSockets : public PatternTree::IOptimizer {
+public:
+    HeatMappingSockets() {};
+
+    void init(PatternTree::APT::Iterator begin, PatternTree::APT::Iterator end, const PatternTree::Cluster& cluster) override {
+        std::shared_ptr<PatternTree::Node> node = cluster.nodes().find("Node1")->second;
+        std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+        std::shared_ptr<PatternTree::Processor> processorA = device->processors().find("1")->second;
+        std::shared_ptr<PatternTree::Processor> processorB = device->processors().find("2")->second;
+
+        teamA_ = std::shared_ptr<PatternTree::Team>(new PatternTree::Team(processorA, 24));
+        teamB_ = std::shared_ptr<PatternTree::Team>(new PatternTree::Team(processorB, 24));
+    };
+
+    void assign(PatternTree::APT::Iterator& step) override {
+        auto splits = step->split(*(step->begin()), 2);
+        step->assign(splits[0], teamA_);
+        step->assign(splits[1], teamB_);
+    };
+
+    double costs() override {
+        return -1.0;
+    };
+
+    std::shared_ptr<PatternTree::Team> teamA_;
+    std::shared_ptr<PatternTree::Team> teamB_;
+};
+
+TEST(TestSuiteHeat, TestHaloTransfer)
+{
+    size_t N = 4096;
+    size_t K = 20;
+
+    auto map_apt = heat(N, K, false);
+    ASSERT_EQ(map_apt->size(), K);
+
+    HeatMappingSockets map_mapping;
+    map_apt->optimize(map_mapping);
+
+    PatternTree::RooflineModel map_model;
+    double map_runtime = map_apt->evaluate(map_model);
+
+    auto stencil_apt = heat(N, K, true);
+    ASSERT_EQ(stencil_apt->size(), K);
+
+    HeatMappingSockets stencil_mapping;
+    stencil_apt->optimize(stencil_mapping);
+
+    PatternTree::RooflineModel stencil_model;
+    double stencil_runtime = stencil_apt->evaluate(stencil_model);
+
+    // Only the halo rows move between the sockets
+    ASSERT_TRUE(stencil_runtime < map_runtime);
+}
@@ -8,6 +8,7 @@
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
@@ -232,3 +233,19 @@ TEST(TestSuiteJacobi, TestOptimized)
     double runtime_ratio = runtime / 0.539;
     ASSERT_TRUE(runtime_ratio < 3 && runtime_ratio > 0.3333);
 }
+
+TEST(TestSuiteJacobi, TestStairClimbing)
+{
+    size_t N = 8192;
+    size_t K = 50;
+    auto apt = jacobi(N, K, false);
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
+
+    double runtime_ratio = runtime / 0.986;
+    ASSERT_TRUE(runtime_ratio < 1.0);
+}
@@ -42,6 +42,8 @@ struct KMeansAssignFunctor : public PatternTree::MapFunctor<int*> {
         return true;
     }
 
+    bool memoize() const override { return true; }
+
 private:
 std::shared_ptr<PatternTree::View<double**>> points_;
 std::shared_ptr<PatternTree::View<double**>> centroids_;
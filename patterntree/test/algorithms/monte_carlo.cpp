@@ -3,11 +3,13 @@
 #include <apt/apt.h>
 #include <apt/step.h>
 #include <patterns/map.h>
+#include <patterns/reduce.h>
 
 #include <cluster/cluster.h>
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
@@ -71,28 +73,10 @@ private:
     long N;
 };
 
-struct MonteCarloReduceFunctor : public PatternTree::MapFunctor<double*> {
-    MonteCarloReduceFunctor(std::shared_ptr<PatternTree::View<double*>> temp) : temp(temp) {}
-
-    void operator () (const int index, PatternTree::View<double*>& x) override {
-        for (long i = 0; i < temp->shape()[0]; i++) {
-            x(index) += (*temp)(i);
-        }
+struct MonteCarloSumFunctor : public PatternTree::ReduceFunctor<double*> {
+    double operator () (const double& lhs, const double& rhs) override {
+        return lhs + rhs;
     };
-
-    void consumes(PatternTree::Dataflow& dataflow) override {
-        dataflow.push_back(temp);
-    };
-
-    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
-    {
-        info.flops = temp->shape()[0];   
-        return true;
-    }
-
-private:
-    std::shared_ptr<PatternTree::View<double*>> temp;
-
 };
 
 std::unique_ptr<PatternTree::APT> monte_carlo(long draws, long estimates, int splits)
@@ -110,8 +94,8 @@ std::unique_ptr<PatternTree::APT> monte_carlo(long draws, long estimates, int sp
     }
 
     auto res = PatternTree::APT::source<double*>("res", 1);
-    std::unique_ptr<MonteCarloReduceFunctor> functor(new MonteCarloReduceFunctor(temp));    
-    PatternTree::APT::map<double*, MonteCarloReduceFunctor>("monte_carlo_reduce", std::move(functor), res);
+    std::unique_ptr<MonteCarloSumFunctor> functor(new MonteCarloSumFunctor());    
+    PatternTree::APT::reduce<double*, MonteCarloSumFunctor>("monte_carlo_reduce", std::move(functor), temp, res);
 
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 
@@ -237,3 +221,21 @@ TEST(TestSuiteMonteCarlo, TestDistributed)
     double runtime_ratio = runtime / 22.238;
     ASSERT_TRUE(runtime_ratio < 8 && runtime_ratio > 0.125);
 }
+
+TEST(TestSuiteMonteCarlo, TestStairClimbing)
+{
+    long estimates = 96;
+    long draws = 1000000000;
+    auto apt = monte_carlo(draws, estimates, 4);
+
+    ASSERT_EQ(apt->size(), 2);
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
+
+    double runtime_ratio = runtime / 22.238;
+    ASSERT_TRUE(runtime_ratio < 1.0);
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <Kokkos_Core.hpp>
+
 #include "unittests/cluster/cluster_test.cpp"
 
 #include "unittests/data/data_test.cpp"
@@ -8,16 +10,28 @@
 #include "unittests/data/disjoint_test.cpp"
 
 #include "unittests/patterns/map_test.cpp"
+#include "unittests/patterns/reduce_test.cpp"
+#include "unittests/patterns/stencil_test.cpp"
 #include "unittests/patterns/pattern_split_test.cpp"
 #include "unittests/apt/step_mapping_test.cpp"
 #include "unittests/apt/happens_before_test.cpp"
 #include "unittests/apt/synchronization_efficiency_test.cpp"
+#include "unittests/apt/archive_test.cpp"
+#include "unittests/apt/mapping_cache_test.cpp"
+#include "unittests/apt/arena_test.cpp"
+#include "unittests/apt/loop_test.cpp"
 
 #include "unittests/performance/dataflow_state_test.cpp"
 #include "unittests/performance/roofline_model_test.cpp"
 
+#include "unittests/optimization/stair_climbing_optimizer_test.cpp"
+
+#include "unittests/execution/step_executor_test.cpp"
+#include "unittests/execution/dataflow_executor_test.cpp"
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
+    Kokkos::ScopeGuard kokkos(argc, argv);
 
     return RUN_ALL_TESTS();
 }
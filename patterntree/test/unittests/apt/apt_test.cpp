@@ -1,11 +1,14 @@
 #pragma once
 
+#include <cstdlib>
 #include <utility>
 #include <memory>
 #include <vector>
 
 #include <apt/apt.h>
+#include <apt/step.h>
 #include <cluster/cluster.h>
+#include <cluster/team.h>
 #include <patterns/map.h>
 #include <data/data.h>
 #include <data/view.h>
@@ -56,6 +59,79 @@ TEST(TestSuiteAPT, TestAddPattern)
     ASSERT_EQ(pattern->produces()[0], data);
 };
 
+std::unique_ptr<PatternTree::APT> identifier_apt(std::shared_ptr<PatternTree::Cluster> cluster)
+{
+    PatternTree::APT::initialize(cluster);
+
+	auto u = PatternTree::APT::source<double*>("u", 128);
+	auto v = PatternTree::APT::source<double*>("v", 128);
+	auto sum = PatternTree::APT::source<double*>("sum", 1);
+
+    std::unique_ptr<DummyMapFunctor> map(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(map), u);
+
+    std::unique_ptr<DummyMapFunctor> named(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>("init", std::move(named), v);
+
+    std::unique_ptr<AverageStencilFunctor> stencil(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(stencil), u, v, 1);
+
+    std::unique_ptr<SumReduceFunctor> reduce(new SumReduceFunctor());
+    PatternTree::APT::reduce<double*, SumReduceFunctor>(std::move(reduce), v, sum);
+
+    return PatternTree::APT::compile();
+};
+
+TEST(TestSuiteAPT, TestIdentifiers)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    // Building the APT does not reseed or advance the random numbers of the program
+    std::srand(42);
+    auto apt = identifier_apt(cluster);
+    int random = std::rand();
+    std::srand(42);
+    ASSERT_EQ(random, std::rand());
+
+    std::vector<std::pair<size_t, std::string>> patterns;
+    for (auto step = apt->begin(); step != apt->end(); ++step)
+    {
+        for (auto pattern = step->begin(); pattern != step->end(); ++pattern)
+        {
+            patterns.push_back({pattern->id(), pattern->identifier()});
+        }
+    }
+    std::sort(patterns.begin(), patterns.end());
+
+    std::vector<std::pair<size_t, std::string>> expected = {
+        {0, "map0"}, {1, "init"}, {2, "stencil2"}, {3, "reduce3"}
+    };
+    ASSERT_EQ(patterns, expected);
+
+    // Identical programs yield identical identifiers and reports of identical mappings
+    auto same = identifier_apt(cluster);
+    auto processor = cluster->nodes().begin()->second->devices().find("CPU1")->second->processors().begin()->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor, processor->cores()));
+    for (auto const& mapped : {apt.get(), same.get()})
+    {
+        for (auto step = mapped->begin(); step != mapped->end(); ++step)
+        {
+            for (auto pattern = step->begin(); pattern != step->end(); ++pattern)
+            {
+                step->split(*pattern, 2);
+                step->assign(*pattern, team);
+            }
+        }
+    }
+    ASSERT_EQ(same->to_json(), apt->to_json());
+
+    // Reports refer to the patterns by their id
+    auto report = apt->to_json();
+    ASSERT_EQ(report["steps"][0]["assignment"][0]["id"], 0);
+    ASSERT_EQ(report["steps"][0]["assignment"][0]["pattern"], "map0");
+    ASSERT_EQ(report["steps"][0]["assignment"][0]["splits"][1]["split_begin"], 64);
+};
+
 TEST(TestSuiteDataBasis, TestBasisOneDim)
 {
     std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
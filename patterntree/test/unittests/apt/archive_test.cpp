@@ -0,0 +1,185 @@
+#pragma once
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include <apt/apt.h>
+#include <apt/archive.h>
+#include <apt/step.h>
+#include <cluster/cluster.h>
+#include <optimization/stair_climbing_optimizer.h>
+#include <performance/roofline_model.h>
+
+#include "../helper.h"
+
+std::unique_ptr<PatternTree::APT> archive_apt(std::shared_ptr<PatternTree::Cluster> cluster, int size)
+{
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto u = PatternTree::APT::source<double*>("u", size);
+	auto v = PatternTree::APT::source<double*>("v", size);
+	auto w = PatternTree::APT::source<double*>("w", size);
+	auto sum = PatternTree::APT::source<double*>("sum", 1);
+
+    std::unique_ptr<ScaleMapFunctor> scale(new ScaleMapFunctor(u));
+    PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(scale), v);
+
+    std::unique_ptr<AverageStencilFunctor> average(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(average), v, w, 1);
+
+    std::unique_ptr<SumReduceFunctor> reduce(new SumReduceFunctor());
+    PatternTree::APT::reduce<double*, SumReduceFunctor>(std::move(reduce), w, sum);
+
+    return PatternTree::APT::compile();
+};
+
+TEST(TestSuiteArchive, TestRestore)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto apt = archive_apt(cluster, 4096);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+
+    PatternTree::RooflineModel model;
+    double costs = apt->evaluate(model);
+    ASSERT_TRUE(apt->save("archive_test.bin"));
+
+    // Same program, restored instead of optimized
+    auto restored = archive_apt(cluster, 4096);
+    ASSERT_EQ(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*restored));
+    ASSERT_TRUE(restored->load("archive_test.bin"));
+
+    auto step = apt->begin();
+    for (auto iter = restored->begin(); iter != restored->end(); ++iter, ++step)
+    {
+        ASSERT_TRUE(iter->complete());
+        ASSERT_EQ(iter->splits().size(), step->splits().size());
+
+        auto pattern = step->begin();
+        for (auto it = iter->begin(); it != iter->end(); ++it, ++pattern)
+        {
+            ASSERT_EQ(it->samples().size(), pattern->samples().size());
+            ASSERT_EQ(it->flops(), pattern->flops());
+
+            auto splits = iter->splits(*it);
+            auto original = step->splits(*pattern);
+            auto by_begin = [](const std::reference_wrapper<const PatternTree::PatternSplit>& a, const std::reference_wrapper<const PatternTree::PatternSplit>& b) {
+                return a.get().begin() < b.get().begin();
+            };
+            std::sort(splits.begin(), splits.end(), by_begin);
+            std::sort(original.begin(), original.end(), by_begin);
+
+            for (size_t i = 0; i < splits.size(); i++)
+            {
+                ASSERT_EQ(splits[i].get().end(), original[i].get().end());
+                ASSERT_EQ(&(iter->assigned(splits[i].get()).value()->processor()), &(step->assigned(original[i].get()).value()->processor()));
+
+                // Subviews of the splits come from the restored samples
+                for (size_t c = 0; c < splits[i].get().consumes().size(); c++)
+                {
+                    ASSERT_EQ(splits[i].get().consumes()[c]->begins(), original[i].get().consumes()[c]->begins());
+                    ASSERT_EQ(splits[i].get().consumes()[c]->ends(), original[i].get().consumes()[c]->ends());
+                }
+            }
+        }
+    }
+
+    PatternTree::RooflineModel restored_model;
+    ASSERT_NEAR(restored->evaluate(restored_model), costs, 1e-12);
+
+    std::remove("archive_test.bin");
+};
+
+TEST(TestSuiteArchive, TestMismatch)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto apt = archive_apt(cluster, 4096);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+    ASSERT_TRUE(apt->save("archive_test.bin"));
+
+    // Different shapes
+    auto resized = archive_apt(cluster, 2048);
+    ASSERT_NE(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*resized));
+    ASSERT_FALSE(resized->load("archive_test.bin"));
+    ASSERT_FALSE(resized->begin()->complete());
+
+    // Different cluster
+    std::shared_ptr<PatternTree::Cluster> fat_tree = PatternTree::Cluster::parse("../clusters/cluster_c18g_fat_tree.json");
+    auto moved = archive_apt(fat_tree, 4096);
+    ASSERT_FALSE(moved->load("archive_test.bin"));
+
+    // Truncated archive
+    std::ifstream input("archive_test.bin", std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    std::ofstream output("archive_test.bin", std::ios::binary | std::ios::trunc);
+    output.write(bytes.data(), bytes.size() / 2);
+    output.close();
+
+    auto truncated = archive_apt(cluster, 4096);
+    ASSERT_FALSE(truncated->load("archive_test.bin"));
+    ASSERT_FALSE(truncated->begin()->complete());
+
+    std::remove("archive_test.bin");
+};
+
+TEST(TestSuiteArchive, TestCosts)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    // Functors of the same type, differing only in their costs
+    auto weighted_apt = [&cluster](size_t weight) {
+        PatternTree::APT::initialize(cluster, 2, 32, true);
+        auto u = PatternTree::APT::source<double*>("u", 4096);
+        std::unique_ptr<WeightedCostsMapFunctor> functor(new WeightedCostsMapFunctor(weight));
+        PatternTree::APT::map<double*, WeightedCostsMapFunctor>(std::move(functor), u);
+        return PatternTree::APT::compile();
+    };
+
+    auto apt = weighted_apt(1);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+    ASSERT_TRUE(apt->save("archive_test.bin"));
+
+    auto heavy = weighted_apt(1000);
+    ASSERT_EQ(PatternTree::Archive::fingerprint(*(apt->begin()->begin())), PatternTree::Archive::fingerprint(*(heavy->begin()->begin())));
+    ASSERT_NE(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*heavy));
+    ASSERT_FALSE(heavy->load("archive_test.bin"));
+
+    // Samples touched by the optimizer do not change the key
+    auto light = weighted_apt(1);
+    ASSERT_EQ(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*light));
+    ASSERT_TRUE(light->load("archive_test.bin"));
+
+    std::remove("archive_test.bin");
+};
+
+TEST(TestSuiteArchive, TestClusterCosts)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = memory_bandwidth_cluster("archive_cluster", 21330.0);
+
+    auto apt = archive_apt(cluster, 4096);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+    ASSERT_TRUE(apt->save("archive_test.bin"));
+
+    // Same cluster, parsed again
+    auto same = archive_apt(memory_bandwidth_cluster("archive_cluster", 21330.0), 4096);
+    ASSERT_TRUE(same->load("archive_test.bin"));
+
+    // The memory bandwidth of the CPUs changed
+    std::shared_ptr<PatternTree::Cluster> faster = memory_bandwidth_cluster("archive_cluster", 42660.0);
+    ASSERT_NE(PatternTree::Archive::fingerprint(*cluster), PatternTree::Archive::fingerprint(*faster));
+
+    auto moved = archive_apt(faster, 4096);
+    ASSERT_FALSE(moved->load("archive_test.bin"));
+    ASSERT_FALSE(moved->begin()->complete());
+
+    std::remove("archive_test.bin");
+    std::filesystem::remove_all("archive_cluster");
+};
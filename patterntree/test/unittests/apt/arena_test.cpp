@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include <apt/apt.h>
+#include <apt/arena.h>
+#include <cluster/cluster.h>
+
+#include "../helper.h"
+
+TEST(TestSuiteArena, TestAlignment)
+{
+    PatternTree::Arena arena;
+
+    void* byte = arena.allocate(1, 1);
+    void* value = arena.allocate(sizeof(double), alignof(double));
+    void* line = arena.allocate(64, 64);
+
+    ASSERT_NE(byte, value);
+    ASSERT_EQ((uintptr_t) value % alignof(double), 0);
+    ASSERT_EQ((uintptr_t) line % 64, 0);
+    ASSERT_GE(arena.allocated(), 1 + sizeof(double) + 64);
+    ASSERT_EQ(arena.chunks(), 1);
+};
+
+TEST(TestSuiteArena, TestChunks)
+{
+    PatternTree::Arena arena;
+
+    // Larger than any chunk
+    void* large = arena.allocate(64 * 1024 * 1024, 8);
+    ASSERT_NE(large, nullptr);
+    ASSERT_EQ(arena.chunks(), 1);
+
+    arena.allocate(64, 8);
+    ASSERT_EQ(arena.chunks(), 2);
+
+    // Reserving less than the remainder of the chunk keeps the chunk
+    arena.reserve(8);
+    ASSERT_EQ(arena.chunks(), 2);
+};
+
+TEST(TestSuiteArena, TestLifetime)
+{
+    std::shared_ptr<PatternTree::Arena> arena = std::make_shared<PatternTree::Arena>();
+    std::shared_ptr<std::vector<int>> values = PatternTree::Arena::make_shared<std::vector<int>>(arena, 3, 7);
+    ASSERT_GT(arena->allocated(), sizeof(std::vector<int>));
+
+    // The object keeps the arena alive
+    std::weak_ptr<PatternTree::Arena> weak = arena;
+    arena.reset();
+    ASSERT_FALSE(weak.expired());
+    ASSERT_EQ(values->at(2), 7);
+
+    values.reset();
+    ASSERT_TRUE(weak.expired());
+};
+
+TEST(TestSuiteArena, TestPatterns)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+    PatternTree::APT::reserve(64);
+
+    auto u = PatternTree::APT::source<double*>("u", 256);
+    auto v = PatternTree::APT::source<double*>("v", 256);
+    for (int k = 0; k < 64; k++)
+    {
+        std::unique_ptr<ScaleMapFunctor> scale(new ScaleMapFunctor(k % 2 == 0 ? u : v));
+        PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(scale), k % 2 == 0 ? v : u);
+    }
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Patterns are allocated from a single reserved chunk of the arena
+    ASSERT_EQ(apt->size(), 64);
+    ASSERT_EQ(apt->arena().chunks(), 1);
+    ASSERT_GE(apt->arena().allocated(), 64 * sizeof(PatternTree::Map<double*>));
+
+    size_t patterns = 0;
+    for (auto step = apt->begin(); step != apt->end(); step++)
+    {
+        for (auto pattern = step->begin(); pattern != step->end(); pattern++)
+        {
+            ASSERT_EQ(pattern->width(), 256);
+            ASSERT_EQ(pattern->samples().size(), 3);
+            patterns++;
+        }
+    }
+    ASSERT_EQ(patterns, 64);
+};
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <cluster/cluster.h>
+#include <optimization/stair_climbing_optimizer.h>
+#include <performance/roofline_model.h>
+
+#include "../helper.h"
+
+std::unique_ptr<PatternTree::APT> loop_apt(std::shared_ptr<PatternTree::Cluster> cluster, bool folding, int iterations)
+{
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+    PatternTree::APT::loop_folding(folding);
+
+    auto u = PatternTree::APT::source<double*>("u", 4096);
+    auto v = PatternTree::APT::source<double*>("v", 4096);
+    auto w = PatternTree::APT::source<double*>("w", 4096);
+
+    // Prologue
+    std::unique_ptr<QuadraticCostsMapFunctor> init(new QuadraticCostsMapFunctor());
+    PatternTree::APT::map<double*, QuadraticCostsMapFunctor>(std::move(init), u);
+
+    for (int k = 0; k < iterations; k++)
+    {
+        std::unique_ptr<ScaleMapFunctor> forward(new ScaleMapFunctor(u));
+        PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(forward), v);
+
+        std::unique_ptr<ScaleMapFunctor> backward(new ScaleMapFunctor(v));
+        PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(backward), u);
+    }
+
+    // Epilogue
+    std::unique_ptr<ScaleMapFunctor> result(new ScaleMapFunctor(u));
+    PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(result), w);
+
+    return PatternTree::APT::compile();
+};
+
+TEST(TestSuiteLoop, TestDetection)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto apt = loop_apt(cluster, true, 16);
+    ASSERT_EQ(apt->size(), 34);
+    ASSERT_EQ(apt->loops().size(), 1);
+
+    auto const& loop = apt->loops().front();
+    ASSERT_EQ(loop.begin, 1);
+    ASSERT_EQ(loop.period, 2);
+    ASSERT_EQ(loop.trips, 16);
+    ASSERT_EQ(loop.end(), 33);
+
+    // Too few repetitions
+    auto short_apt = loop_apt(cluster, true, 2);
+    ASSERT_EQ(short_apt->loops().size(), 0);
+
+    auto unfolded = loop_apt(cluster, false, 16);
+    ASSERT_EQ(unfolded->loops().size(), 0);
+};
+
+TEST(TestSuiteLoop, TestCosts)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto unfolded = loop_apt(cluster, false, 16);
+    PatternTree::StairClimbingOptimizer unfolded_optimizer;
+    unfolded->optimize(unfolded_optimizer);
+
+    PatternTree::RooflineModel unfolded_model;
+    double unfolded_costs = unfolded->evaluate(unfolded_model);
+    ASSERT_EQ(unfolded_model.report()["repeated-steps"], 0);
+
+    auto folded = loop_apt(cluster, true, 16);
+    PatternTree::StairClimbingOptimizer folded_optimizer;
+    folded->optimize(folded_optimizer);
+
+    for (auto iter = folded->begin(); iter != folded->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+    }
+
+    PatternTree::RooflineModel folded_model;
+    double folded_costs = folded->evaluate(folded_model);
+
+    // Folding repeats the steady state of the loop instead of evaluating it again
+    nlohmann::json report = folded_model.report();
+    ASSERT_GT(report["repeated-steps"], 0);
+    ASSERT_EQ(report["steps"], 34);
+
+    ASSERT_GT(folded_costs, 0.0);
+    ASSERT_NEAR(folded_costs, unfolded_costs, 1e-9 * unfolded_costs);
+    ASSERT_NEAR(folded_optimizer.costs(), folded_costs, 1e-12);
+    ASSERT_NEAR(unfolded_optimizer.costs(), unfolded_costs, 1e-12);
+};
+
+TEST(TestSuiteLoop, TestFixedMapping)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    auto folded = loop_apt(cluster, true, 16);
+    optimizer.init(folded->begin(), folded->end(), *cluster);
+    auto team = optimizer.teams().front();
+
+    for (auto iter = folded->begin(); iter != folded->end(); iter++)
+    {
+        for (auto it = iter->begin(); it != iter->end(); ++it)
+        {
+            iter->assign(*it, team);
+        }
+    }
+
+    PatternTree::RooflineModel folded_model;
+    double folded_costs = folded->evaluate(folded_model);
+    ASSERT_GT(folded_model.report()["repeated-steps"], 0);
+
+    // Unfolded evaluation of the same mapping
+    PatternTree::RooflineModel unfolded_model;
+    for (auto iter = folded->begin(); iter != folded->end(); iter++)
+    {
+        unfolded_model.update(*iter);
+    }
+
+    ASSERT_NEAR(folded_costs, unfolded_model.costs(), 1e-9 * folded_costs);
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <filesystem>
+
+#include <apt/apt.h>
+#include <apt/archive.h>
+#include <apt/mapping_cache.h>
+#include <cluster/cluster.h>
+#include <optimization/stair_climbing_optimizer.h>
+#include <performance/roofline_model.h>
+
+#include "../helper.h"
+
+std::unique_ptr<PatternTree::APT> mapping_cache_apt(std::shared_ptr<PatternTree::Cluster> cluster, int iterations, size_t interpolation_frequency)
+{
+    PatternTree::APT::initialize(cluster, interpolation_frequency, 32, true);
+
+	auto u = PatternTree::APT::source<double*>("u", 4096);
+	auto v = PatternTree::APT::source<double*>("v", 4096);
+
+    for (int k = 0; k < iterations; k++)
+    {
+        std::unique_ptr<ScaleMapFunctor> scale(new ScaleMapFunctor(u));
+        PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(scale), v);
+
+        std::unique_ptr<ConstantCostsMapFunctor> constant(new ConstantCostsMapFunctor());
+        PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(constant), u);
+    }
+
+    return PatternTree::APT::compile();
+};
+
+TEST(TestSuiteMappingCache, TestFingerprint)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto apt = mapping_cache_apt(cluster, 1, 2);
+    auto same = mapping_cache_apt(cluster, 1, 2);
+    auto frequency = mapping_cache_apt(cluster, 1, 4);
+
+    ASSERT_EQ(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*same));
+    ASSERT_NE(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*frequency));
+
+    // Patterns differ in their functor only, the constant map writes u after it is read
+    ASSERT_EQ(apt->size(), 2);
+    auto scale = apt->begin()->begin();
+    auto constant = (++(apt->begin()))->begin();
+    ASSERT_EQ(scale->width(), constant->width());
+    ASSERT_NE(PatternTree::Archive::fingerprint(*scale), PatternTree::Archive::fingerprint(*constant));
+    ASSERT_EQ(PatternTree::Archive::fingerprint(*scale), PatternTree::Archive::fingerprint(*(same->begin()->begin())));
+    ASSERT_NE(PatternTree::Archive::fingerprint(*scale), PatternTree::Archive::fingerprint(*(frequency->begin()->begin())));
+
+    // Clusters
+    std::shared_ptr<PatternTree::Cluster> fat_tree = PatternTree::Cluster::parse("../clusters/cluster_c18g_fat_tree.json");
+    ASSERT_EQ(PatternTree::Archive::fingerprint(*cluster), PatternTree::Archive::fingerprint(apt->cluster()));
+    ASSERT_NE(PatternTree::Archive::fingerprint(*cluster), PatternTree::Archive::fingerprint(*fat_tree));
+};
+
+TEST(TestSuiteMappingCache, TestHit)
+{
+    std::filesystem::remove_all("mapping_cache_test");
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::MappingCache cache("mapping_cache_test");
+
+    auto apt = mapping_cache_apt(cluster, 2, 2);
+    ASSERT_FALSE(cache.load(*apt));
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer, cache);
+    ASSERT_TRUE(std::filesystem::exists(cache.path(PatternTree::Archive::key(*apt))));
+
+    PatternTree::RooflineModel model;
+    double costs = apt->evaluate(model);
+
+    // Restored without initializing the optimizer
+    auto cached = mapping_cache_apt(cluster, 2, 2);
+    PatternTree::StairClimbingOptimizer cached_optimizer;
+    cached->optimize(cached_optimizer, cache);
+    ASSERT_EQ(cached_optimizer.teams().size(), 0);
+
+    for (auto iter = cached->begin(); iter != cached->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+    }
+
+    PatternTree::RooflineModel cached_model;
+    ASSERT_NEAR(cached->evaluate(cached_model), costs, 1e-12);
+
+    std::filesystem::remove_all("mapping_cache_test");
+};
+
+TEST(TestSuiteMappingCache, TestWarmStart)
+{
+    std::filesystem::remove_all("mapping_cache_test");
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::MappingCache cache("mapping_cache_test");
+
+    auto apt = mapping_cache_apt(cluster, 2, 2);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer, cache);
+
+    // Another iteration, the patterns of the first iterations are mapped as cached
+    auto longer = mapping_cache_apt(cluster, 3, 2);
+    ASSERT_NE(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*longer));
+    ASSERT_FALSE(cache.load(*longer));
+    ASSERT_EQ(cache.warm_start(*longer), 4);
+
+    size_t complete = 0;
+    for (auto iter = longer->begin(); iter != longer->end(); iter++)
+    {
+        complete += iter->complete() ? 1 : 0;
+    }
+    ASSERT_EQ(complete, 4);
+
+    // Different cluster
+    std::shared_ptr<PatternTree::Cluster> fat_tree = PatternTree::Cluster::parse("../clusters/cluster_c18g_fat_tree.json");
+    auto moved = mapping_cache_apt(fat_tree, 2, 2);
+    ASSERT_EQ(cache.warm_start(*moved), 0);
+
+    // Climbs from the warm start and archives the result
+    PatternTree::StairClimbingOptimizer longer_optimizer;
+    longer->optimize(longer_optimizer, cache);
+    for (auto iter = longer->begin(); iter != longer->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+    }
+    ASSERT_TRUE(std::filesystem::exists(cache.path(PatternTree::Archive::key(*longer))));
+
+    PatternTree::RooflineModel model;
+    ASSERT_NEAR(longer_optimizer.costs(), longer->evaluate(model), 1e-12);
+
+    std::filesystem::remove_all("mapping_cache_test");
+};
+
+TEST(TestSuiteMappingCache, TestClusterCosts)
+{
+    std::filesystem::remove_all("mapping_cache_test");
+    PatternTree::MappingCache cache("mapping_cache_test");
+
+    auto apt = mapping_cache_apt(memory_bandwidth_cluster("mapping_cache_cluster", 21330.0), 2, 2);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer, cache);
+
+    // Clusters differing only in the memory bandwidth of their CPUs share no archives
+    auto faster = mapping_cache_apt(memory_bandwidth_cluster("mapping_cache_cluster", 42660.0), 2, 2);
+    ASSERT_NE(PatternTree::Archive::key(*apt), PatternTree::Archive::key(*faster));
+    ASSERT_FALSE(cache.load(*faster));
+    ASSERT_EQ(cache.warm_start(*faster), 0);
+
+    // Optimized for the changed cluster instead of restored
+    PatternTree::StairClimbingOptimizer faster_optimizer;
+    faster->optimize(faster_optimizer, cache);
+    ASSERT_GT(faster_optimizer.teams().size(), 0);
+    ASSERT_TRUE(std::filesystem::exists(cache.path(PatternTree::Archive::key(*faster))));
+
+    std::filesystem::remove_all("mapping_cache_test");
+    std::filesystem::remove_all("mapping_cache_cluster");
+};
@@ -9,6 +9,7 @@
 #include <cluster/cluster.h>
 #include <cluster/processor.h>
 #include <cluster/team.h>
+#include <performance/roofline_model.h>
 
 #include "../helper.h"
 
@@ -261,3 +262,108 @@ TEST(TestSuiteStepMapping, TestAssignAndFreeMultiple)
     ASSERT_FALSE(step.assigned(splitB).has_value());
     ASSERT_EQ(step.assigned(*team).size(), 0);
 }
+
+TEST(TestSuiteStepMapping, TestBalancedSplit)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 130);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 130);
+
+    std::unique_ptr<SplitMapFunctor> functor(new SplitMapFunctor(viewB));
+    PatternTree::APT::map<double*, SplitMapFunctor>(std::move(functor), viewA);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Assertions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    // Index i costs i + 1 FLOPS, the first 92 indices cover half of the FLOPS
+    auto splits = step.split_balanced(map, {1.0, 1.0});
+    ASSERT_EQ(splits.size(), 2);
+    ASSERT_EQ(splits[0].get().begin(), 0);
+    ASSERT_EQ(splits[0].get().end(), 92);
+    ASSERT_EQ(splits[1].get().begin(), 92);
+    ASSERT_EQ(splits[1].get().end(), 130);
+    ASSERT_NEAR(splits[0].get().flops(), splits[1].get().flops(), 100);
+
+    auto subviewB = splits[1].get().consumes()[1];
+    ASSERT_EQ(subviewB->begins()[0], 92);
+    ASSERT_EQ(subviewB->ends()[0], 130);
+
+    ASSERT_EQ(step.splits(map).size(), 2);
+}
+
+TEST(TestSuiteStepMapping, TestBalancedWeights)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 90);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Assertions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    auto splits = step.split_balanced(map, {2.0, 1.0});
+    ASSERT_EQ(splits.size(), 2);
+    ASSERT_EQ(splits[0].get().width(), 60);
+    ASSERT_EQ(splits[1].get().width(), 30);
+
+    // Each split covers at least one index
+    splits = step.split_balanced(map, {1.0, 1e-9});
+    ASSERT_EQ(splits.size(), 2);
+    ASSERT_EQ(splits[0].get().width(), 89);
+    ASSERT_EQ(splits[1].get().width(), 1);
+
+    ASSERT_EQ(step.split_balanced(map, {1.0, 0.0}).size(), 0);
+    ASSERT_EQ(step.split_balanced(map, std::vector<double>(91, 1.0)).size(), 0);
+}
+
+TEST(TestSuiteStepMapping, TestBalancedTeams)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processor = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(processor, 24));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team(processor, 12));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 3600);
+
+    // Constant FLOPS without memory traffic, such that the teams are bound by their peak FLOPS
+    std::unique_ptr<WeightedCostsMapFunctor> functor(new WeightedCostsMapFunctor(1));
+    PatternTree::APT::map<double*, WeightedCostsMapFunctor>(std::move(functor), view);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Assertions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    PatternTree::RooflineModel model;
+    std::vector<double> throughputs = {
+        model.peak_flops(teamA->processor(), teamA->cores()),
+        model.peak_flops(teamB->processor(), teamB->cores())
+    };
+    auto splits = step.split_balanced(map, throughputs);
+    ASSERT_EQ(splits[0].get().width(), 2400);
+    ASSERT_EQ(splits[1].get().width(), 1200);
+
+    // Both teams finish at the same time
+    double costsA = model.execution_costs({splits[0]}, *teamA);
+    double costsB = model.execution_costs({splits[1]}, *teamB);
+    ASSERT_DOUBLE_EQ(costsA, costsB);
+}
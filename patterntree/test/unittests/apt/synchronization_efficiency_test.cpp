@@ -153,4 +153,112 @@ TEST(TestSuiteSynchronizationEfficiency, TestStopAndGo)
     ASSERT_EQ(step2.begin()->consumes()[0], data2);
     
     ASSERT_EQ((++(step2.begin()))->consumes()[0], data3);
-};
\ No newline at end of file
+};
+
+TEST(TestSuiteSynchronizationEfficiency, TestDisjointSlices)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto data = PatternTree::APT::source<double*>("field", 512);
+    auto lower = PatternTree::View<double*>::slice(data->data(), std::make_pair(0, 64));
+    auto upper = PatternTree::View<double*>::slice(data->data(), std::make_pair(256, 320));
+    auto middle = PatternTree::View<double*>::slice(data->data(), std::make_pair(128, 192));
+
+    std::unique_ptr<DummyMapFunctor> functor1(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor1), lower);
+
+    std::unique_ptr<DummyMapFunctor> functor2(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor2), upper);
+
+    std::unique_ptr<DummyMapFunctor> functor3(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor3), lower);
+
+    std::unique_ptr<DummyMapFunctor> functor4(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor4), upper);
+
+    std::unique_ptr<DummyMapFunctor> functor5(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor5), middle);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    ASSERT_EQ(apt->size(), 2);
+
+    PatternTree::Step& step1 = *(apt->begin());
+    PatternTree::Step& step2 = *(++(apt->begin()));
+
+    ASSERT_EQ(step1.size(), 3);
+    ASSERT_EQ(step2.size(), 2);
+
+    ASSERT_EQ((++(++(step1.begin())))->consumes()[0], middle);
+};
+
+TEST(TestSuiteSynchronizationEfficiency, TestWriteAfterRead)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto a = PatternTree::APT::source<double*>("a", 64);
+	auto b = PatternTree::APT::source<double*>("b", 64);
+	auto c = PatternTree::APT::source<double*>("c", 64);
+	auto d = PatternTree::APT::source<double*>("d", 64);
+
+    // Reads b
+    std::unique_ptr<TwoViewsMapFunctor> functor(new TwoViewsMapFunctor(b));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functor), a);
+
+    // Writes b after the read, then again
+    std::unique_ptr<AverageStencilFunctor> stencil1(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(stencil1), c, b, 1);
+
+    std::unique_ptr<AverageStencilFunctor> stencil2(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(stencil2), d, b, 1);
+
+    // Writes d after the read of the stencil
+    std::unique_ptr<DummyMapFunctor> functor3(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functor3), d);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    ASSERT_EQ(apt->size(), 4);
+
+    auto iter = apt->begin();
+    PatternTree::Step& step1 = *(iter++);
+    PatternTree::Step& step2 = *(iter++);
+    PatternTree::Step& step3 = *(iter++);
+    PatternTree::Step& step4 = *(iter++);
+
+    ASSERT_EQ(step1.size(), 1);
+    ASSERT_EQ(step1.begin()->produces()[0], a);
+
+    ASSERT_EQ(step2.size(), 1);
+    ASSERT_EQ(step2.begin()->consumes()[0], c);
+
+    ASSERT_EQ(step3.size(), 1);
+    ASSERT_EQ(step3.begin()->consumes()[0], d);
+
+    ASSERT_EQ(step4.size(), 1);
+    ASSERT_EQ(step4.begin()->produces()[0], d);
+};
+
+TEST(TestSuiteSynchronizationEfficiency, TestReadAfterRead)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto a = PatternTree::APT::source<double*>("a", 64);
+	auto b = PatternTree::APT::source<double*>("b", 64);
+	auto c = PatternTree::APT::source<double*>("c", 64);
+
+    // Concurrent reads of c do not order the patterns
+    std::unique_ptr<TwoViewsMapFunctor> functor1(new TwoViewsMapFunctor(c));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functor1), a);
+
+    std::unique_ptr<AverageStencilFunctor> stencil(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(stencil), c, b, 1);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    ASSERT_EQ(apt->size(), 1);
+    ASSERT_EQ(apt->begin()->size(), 2);
+};
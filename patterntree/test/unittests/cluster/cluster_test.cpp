@@ -8,12 +8,25 @@ TEST(TestSuiteCluster, TestProcessor) {
 
     ASSERT_EQ(processor->cores(), 24);
     ASSERT_EQ(processor->arithmetic_units(), 4);
+    ASSERT_EQ(processor->vector_width(), 8);
+    ASSERT_TRUE(processor->fma());
     ASSERT_EQ(processor->frequency(), 2100);
     ASSERT_EQ(processor->cache_size(), 32);
     ASSERT_EQ(processor->cache_latency(), 20.95);
     ASSERT_EQ(processor->cache_bandwidth(), 38000.0);
 }
 
+TEST(TestSuiteCluster, TestVectorization) {
+    ASSERT_EQ(PatternTree::Processor::vector_width("avx512"), 8);
+    ASSERT_EQ(PatternTree::Processor::vector_width("avx2"), 4);
+    ASSERT_EQ(PatternTree::Processor::vector_width("sse4.2"), 2);
+    ASSERT_EQ(PatternTree::Processor::vector_width(""), 1);
+
+    std::shared_ptr<PatternTree::Processor> processor = PatternTree::Processor::parse("../clusters/GPU/sm_tesla_v100.json");
+    ASSERT_EQ(processor->vector_width(), 1);
+    ASSERT_TRUE(processor->fma());
+}
+
 TEST(TestSuiteCluster, TestDevice) {
     std::shared_ptr<const PatternTree::Device> device = PatternTree::Device::parse("../clusters/CPU/cpu_platinum_8160.json");
 
@@ -155,3 +168,110 @@ TEST(TestSuiteCluster, TestDistance) {
     ASSERT_EQ(PatternTree::Cluster::distance(*processorA, *processorC), PatternTree::Cluster::Distance::NODE);
     ASSERT_EQ(PatternTree::Cluster::distance(*processorA, *processorD), PatternTree::Cluster::Distance::CLUSTER);
 }
+
+TEST(TestSuiteCluster, TestIndices) {
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto node1 = cluster->nodes().at("Node1");
+    auto node2 = cluster->nodes().at("Node2");
+    ASSERT_EQ(node1->index(), 0);
+    ASSERT_EQ(node2->index(), 1);
+
+    ASSERT_EQ(node1->devices().at("CPU1")->index(), 0);
+    ASSERT_EQ(node1->devices().at("GPU1")->index(), 1);
+    ASSERT_EQ(node1->devices().at("GPU2")->index(), 2);
+
+    ASSERT_EQ(node1->devices().at("CPU1")->cluster_index(), 0);
+    ASSERT_EQ(node1->devices().at("GPU2")->cluster_index(), 2);
+    ASSERT_EQ(node2->devices().at("CPU1")->cluster_index(), 3);
+    ASSERT_EQ(node2->devices().at("GPU2")->cluster_index(), 5);
+}
+
+TEST(TestSuiteCluster, TestProcessorConnections) {
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto node1 = cluster->nodes().at("Node1");
+    auto node2 = cluster->nodes().at("Node2");
+    auto cpu1 = node1->devices().at("CPU1")->processors().begin()->second;
+    auto gpu1 = node1->devices().at("GPU1")->processors().begin()->second;
+    auto cpu2 = node2->devices().at("CPU1")->processors().begin()->second;
+
+    // Through the node
+    ASSERT_EQ(cluster->bandwidth(*cpu1, *gpu1), 12152.0);
+    ASSERT_EQ(cluster->latency(*gpu1, *cpu1), 7210.0);
+
+    // Across the cluster
+    ASSERT_EQ(cluster->bandwidth(*cpu1, *cpu2), 4148.0);
+    ASSERT_EQ(cluster->latency(*gpu1, *cpu2), 1840.0);
+
+    // Same device
+    ASSERT_EQ(cluster->bandwidth(*cpu1, *cpu1), 0.0);
+}
+
+TEST(TestSuiteCluster, TestFullyRoutes) {
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    auto node1 = cluster->nodes().at("Node1");
+    auto node2 = cluster->nodes().at("Node2");
+
+    // A link per direction between the two nodes
+    ASSERT_EQ(cluster->topology(), "fully");
+    ASSERT_EQ(cluster->links().size(), 2);
+    ASSERT_EQ(cluster->route(*node1, *node1).size(), 0);
+    ASSERT_EQ(cluster->route(*node1, *node2).size(), 1);
+    ASSERT_NE(cluster->route(*node1, *node2)[0], cluster->route(*node2, *node1)[0]);
+    ASSERT_EQ(cluster->links()[cluster->route(*node1, *node2)[0]].bandwidth, 4148.0);
+}
+
+TEST(TestSuiteCluster, TestFatTree) {
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g_fat_tree.json");
+
+    auto node1 = cluster->nodes().at("Node1");
+    auto node2 = cluster->nodes().at("Node2");
+    auto node3 = cluster->nodes().at("Node3");
+
+    // Four nodes, two switches and the root, two directed links per edge
+    ASSERT_EQ(cluster->topology(), "fat-tree");
+    ASSERT_EQ(cluster->links().size(), 12);
+
+    // Through the common switch
+    auto route = cluster->route(*node1, *node2);
+    ASSERT_EQ(route.size(), 2);
+    ASSERT_EQ(cluster->bandwidth(*node1, *node2), 4148.0);
+    ASSERT_EQ(cluster->latency(*node1, *node2), 1840.0);
+
+    // Through the root, the upper links double their bandwidth
+    route = cluster->route(*node1, *node3);
+    ASSERT_EQ(route.size(), 4);
+    ASSERT_EQ(route[0], cluster->route(*node1, *node2)[0]);
+    ASSERT_EQ(cluster->links()[route[1]].bandwidth, 8296.0);
+    ASSERT_EQ(cluster->bandwidth(*node1, *node3), 4148.0);
+    ASSERT_EQ(cluster->latency(*node1, *node3), 3680.0);
+
+    // Processors across the cluster use the routes
+    auto cpu1 = node1->devices().at("CPU1")->processors().begin()->second;
+    auto cpu3 = node3->devices().at("CPU1")->processors().begin()->second;
+    ASSERT_EQ(cluster->latency(*cpu1, *cpu3), 3680.0);
+}
+
+TEST(TestSuiteCluster, TestTorus) {
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g_torus.json");
+
+    auto node1 = cluster->nodes().at("Node1");
+    auto node3 = cluster->nodes().at("Node3");
+    auto node6 = cluster->nodes().at("Node6");
+
+    // Rings of two share a link per direction, rings of three have three
+    ASSERT_EQ(cluster->topology(), "torus");
+    ASSERT_EQ(cluster->links().size(), 18);
+
+    // Wraps around the ring of the second dimension
+    ASSERT_EQ(cluster->route(*node1, *node3).size(), 1);
+    ASSERT_EQ(cluster->latency(*node1, *node3), 1840.0);
+
+    // One hop per dimension
+    ASSERT_EQ(cluster->route(*node1, *node6).size(), 2);
+    ASSERT_EQ(cluster->bandwidth(*node1, *node6), 4148.0);
+    ASSERT_EQ(cluster->latency(*node1, *node6), 3680.0);
+    ASSERT_EQ(cluster->route(*node6, *node1).size(), 2);
+}
@@ -23,3 +23,65 @@ TEST(TestSuiteData, TestDataTwoDim)
     ASSERT_EQ(data->shape()[0], 3);
     ASSERT_EQ(data->shape()[1], 2);
 }
+
+TEST(TestSuiteData, TestBindZeroCopy)
+{
+    std::shared_ptr<PatternTree::Data<double**>> data(new PatternTree::Data<double**>("test_data", 3, 2));
+    std::vector<double> buffer(6);
+
+    data->bind(buffer.data());
+
+    ASSERT_FALSE(data->is_symbolic());
+    ASSERT_EQ(data->values().data(), buffer.data());
+    ASSERT_EQ(&(data->values()(2, 1)), &(buffer[5]));
+}
+
+TEST(TestSuiteData, TestAllocateLayoutRight)
+{
+    std::shared_ptr<PatternTree::Data<double**>> data(new PatternTree::Data<double**>("test_data", 3, 5));
+    data->set_alignment(64);
+    data->allocate();
+
+    auto values = data->values();
+    ASSERT_FALSE(data->is_symbolic());
+    ASSERT_EQ(values.extent(0), 3);
+    ASSERT_EQ(values.extent(1), 5);
+    ASSERT_EQ(values.stride(0), 8);
+    ASSERT_EQ(values.stride(1), 1);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(values.data()) % 64, 0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&values(1, 0)) % 64, 0);
+}
+
+TEST(TestSuiteData, TestAllocateLayoutLeft)
+{
+    std::shared_ptr<PatternTree::Data<int**>> data(new PatternTree::Data<int**>("test_data", 3, 5));
+    data->set_layout(PatternTree::IData::Layout::LEFT);
+    data->set_alignment(128);
+    data->allocate();
+
+    auto values = data->values();
+    ASSERT_EQ(values.stride(0), 1);
+    ASSERT_EQ(values.stride(1), 32);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(values.data()) % 128, 0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&values(0, 4)) % 128, 0);
+}
+
+TEST(TestSuiteData, TestAlignmentInvalid)
+{
+    std::shared_ptr<PatternTree::Data<double**>> data(new PatternTree::Data<double**>("test_data", 3, 5));
+
+    // Not a power of two, not a multiple of the element
+    ASSERT_FALSE(data->set_alignment(48));
+    ASSERT_FALSE(data->set_alignment(4));
+    ASSERT_FALSE(data->set_alignment(0));
+    ASSERT_EQ(data->alignment(), 64);
+
+    ASSERT_TRUE(data->set_alignment(32));
+    data->allocate();
+
+    auto values = data->values();
+    ASSERT_EQ(values.stride(0), 8);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(values.data()) % 32, 0);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(&values(1, 0)) % 32, 0);
+    ASSERT_EQ(&(values(2, 4)), &((*data)(2, 4)));
+}
@@ -141,6 +141,38 @@ TEST(TestSuiteView, TestViewSliceTwoDim)
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 }
 
+TEST(TestSuiteView, TestViewBasisRangeTwoDim)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32);
+
+	auto view = PatternTree::APT::source<double**>("field", 96, 35);
+    auto data = view->data().lock();
+    auto slice = PatternTree::View<double**>::slice(data, std::make_pair(40, 70), std::make_pair(33, 35));
+    auto other = PatternTree::View<double**>::slice(data, std::make_pair(64, 96), std::make_pair(0, 32));
+
+    auto range = PatternTree::IView::basis_range(*slice);
+
+    ASSERT_EQ(range.begin_0, 1);
+    ASSERT_EQ(range.end_0, 3);
+    ASSERT_EQ(range.begin_1, 1);
+    ASSERT_EQ(range.end_1, 2);
+    ASSERT_EQ(range.length_1, 2);
+    ASSERT_EQ(range.size(), 2);
+
+    auto ids = PatternTree::IView::basis_ids(*slice);
+
+    ASSERT_EQ(ids.size(), 2);
+    ASSERT_EQ(ids[0], 3);
+    ASSERT_EQ(ids[1], 5);
+
+    ASSERT_FALSE(range.overlaps(PatternTree::IView::basis_range(*other)));
+    ASSERT_TRUE(slice->disjoint(*other));
+    ASSERT_FALSE(slice->disjoint(*view));
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+}
+
 TEST(TestSuiteView, TestViewJoinOneDim)
 {
     std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
@@ -179,3 +211,62 @@ TEST(TestSuiteView, TestViewJoinTwoDim)
 
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 }
+
+TEST(TestSuiteView, TestViewValuesTwoDim)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32);
+
+	auto view = PatternTree::APT::source<double**>("field", 10, 6);
+    auto data = view->data().lock();
+    data->allocate();
+
+    auto slice = PatternTree::View<double**>::slice(data, std::make_pair(2, 5), std::make_pair(1, 4));
+    auto values = slice->values();
+
+    ASSERT_EQ(values.extent(0), 3);
+    ASSERT_EQ(values.extent(1), 3);
+    ASSERT_EQ(&(values(0, 0)), &((*view)(2, 1)));
+    ASSERT_EQ(&(values(2, 2)), &((*view)(4, 3)));
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+}
+
+TEST(TestSuiteView, TestViewKBytes)
+{
+	std::shared_ptr<PatternTree::Data<double*>> doubles(new PatternTree::Data<double*>("doubles", 1000));
+	std::shared_ptr<PatternTree::Data<int*>> ints(new PatternTree::Data<int*>("ints", 1000));
+	std::shared_ptr<PatternTree::Data<float**>> floats(new PatternTree::Data<float**>("floats", 100, 10));
+
+    ASSERT_EQ(PatternTree::View<double*>::full(doubles)->kbytes(), 8.0);
+    ASSERT_EQ(PatternTree::View<int*>::full(ints)->kbytes(), 4.0);
+    ASSERT_EQ(PatternTree::View<int*>::element(ints, 10)->element_size(), sizeof(int));
+    ASSERT_EQ(PatternTree::View<float**>::full(floats)->kbytes(), 4.0);
+}
+
+TEST(TestSuiteView, TestViewRecorder)
+{
+	std::shared_ptr<PatternTree::Data<double*>> data(new PatternTree::Data<double*>("field", 100));
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(data);
+
+    view->record_accesses();
+    (*view)(10);
+
+    {
+        // Accesses while the recorder is active are kept apart from the view
+        PatternTree::IView::Recorder recorder;
+        view->record_accesses();
+        (*view)(40);
+        (*view)(42);
+        ASSERT_EQ(view->accessed_bytes(), 2 * sizeof(double));
+
+        auto accessed = view->accessed();
+        ASSERT_EQ(accessed->begins()[0], 40);
+        ASSERT_EQ(accessed->ends()[0], 43);
+    }
+
+    ASSERT_EQ(view->accessed_bytes(), sizeof(double));
+    auto accessed = view->accessed();
+    ASSERT_EQ(accessed->begins()[0], 10);
+    ASSERT_EQ(accessed->ends()[0], 11);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <data/data.h>
+#include <data/view.h>
+#include <patterns/map.h>
+#include <cluster/cluster.h>
+
+#include <execution/dataflow_executor.h>
+
+#include "../helper.h"
+
+TEST(TestSuiteDataflowExecutor, TestIndependent)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32, false);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 64);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 64);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorA(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorA), viewA);
+    std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), viewB);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 2);
+
+    PatternTree::DataflowExecutor executor;
+    executor.build(apt->begin(), apt->end());
+
+    // Steps without shared data do not wait for each other
+    ASSERT_EQ(executor.size(), 2);
+    ASSERT_EQ(executor.dependencies(0), 0);
+    ASSERT_EQ(executor.dependencies(1), 0);
+    ASSERT_EQ(executor.successors(0).size(), 0);
+}
+
+TEST(TestSuiteDataflowExecutor, TestDependencies)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster, 2, 32, false);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 128);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 128);
+
+    // Read after write: B = 2 * A, write after read: A = A + 1
+    std::unique_ptr<ScaleMapFunctor> functorA(new ScaleMapFunctor(viewA));
+    PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(functorA), viewB);
+    std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), viewA);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    auto step = apt->begin();
+    step->split(*(step->begin()), 2);
+
+    PatternTree::DataflowExecutor executor(8);
+    executor.build(apt->begin(), apt->end());
+
+    ASSERT_EQ(executor.size(), 3);
+    ASSERT_EQ(executor.dependencies(0), 0);
+    ASSERT_EQ(executor.dependencies(1), 0);
+    ASSERT_EQ(executor.dependencies(2), 2);
+
+    std::vector<double> fieldA(128);
+    std::vector<double> fieldB(128, 0.0);
+    for (size_t i = 0; i < fieldA.size(); i++)
+    {
+        fieldA[i] = i;
+    }
+    apt->execute(executor, {{"fieldA", fieldA.data()}, {"fieldB", fieldB.data()}});
+
+    for (size_t i = 0; i < fieldA.size(); i++)
+    {
+        ASSERT_EQ(fieldB[i], 2.0 * i);
+        ASSERT_EQ(fieldA[i], i + 1.0);
+    }
+}
+
+TEST(TestSuiteDataflowExecutor, TestChain)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 256);
+
+    for (int k = 0; k < 10; k++)
+    {
+        std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+        PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view);
+    }
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 10);
+
+    std::vector<double> field(256, 0.0);
+    PatternTree::DataflowExecutor executor(16);
+    apt->execute(executor, {{"field", field.data()}});
+
+    for (size_t k = 1; k < executor.size(); k++)
+    {
+        ASSERT_EQ(executor.dependencies(k), 1);
+    }
+    for (size_t i = 0; i < field.size(); i++)
+    {
+        ASSERT_EQ(field[i], 10.0);
+    }
+}
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <vector>
+
+#include <Kokkos_Core.hpp>
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <data/data.h>
+#include <data/view.h>
+#include <patterns/map.h>
+#include <cluster/cluster.h>
+#include <cluster/team.h>
+
+#include <execution/step_executor.h>
+
+#include "../helper.h"
+
+TEST(TestSuiteStepExecutor, TestUnassigned)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 128);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    std::vector<double> field(128, 1.0);
+    apt->execute({{"field", field.data()}});
+
+    ASSERT_FALSE(view->is_symbolic());
+    for (size_t i = 0; i < field.size(); i++)
+    {
+        ASSERT_EQ(field[i], 2.0);
+    }
+}
+
+TEST(TestSuiteStepExecutor, TestSplitTeams)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(device->processors().find("1")->second, 2));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team(device->processors().find("2")->second, 4));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 130);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 130);
+
+    std::unique_ptr<ScaleMapFunctor> functor(new ScaleMapFunctor(viewB));
+    PatternTree::APT::map<double*, ScaleMapFunctor>(std::move(functor), viewA);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+    auto splits = step.split(map, 4);
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        step.assign(splits[i].get(), (i % 2 == 0) ? teamA : teamB);
+    }
+    ASSERT_TRUE(step.complete());
+
+    std::vector<double> fieldA(130, 0.0);
+    std::vector<double> fieldB(130);
+    for (size_t i = 0; i < fieldB.size(); i++)
+    {
+        fieldB[i] = i;
+    }
+
+    PatternTree::StepExecutor executor;
+    apt->execute(executor, {{"fieldA", fieldA.data()}, {"fieldB", fieldB.data()}});
+
+    for (size_t i = 0; i < fieldA.size(); i++)
+    {
+        ASSERT_EQ(fieldA[i], 2.0 * i);
+    }
+}
+
+TEST(TestSuiteStepExecutor, TestConcurrentPatterns)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::vector<std::shared_ptr<PatternTree::Team>> teams = {
+        std::shared_ptr<PatternTree::Team>(new PatternTree::Team(device->processors().find("1")->second, 2)),
+        std::shared_ptr<PatternTree::Team>(new PatternTree::Team(device->processors().find("2")->second, 2)),
+        std::shared_ptr<PatternTree::Team>(new PatternTree::Team(device->processors().find("2")->second, 1))
+    };
+
+    PatternTree::APT::initialize(cluster);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 64);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 64);
+	auto viewC = PatternTree::APT::source<double*>("fieldC", 64);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorA(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorA), viewA);
+    std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), viewB);
+    std::unique_ptr<ConstantCostsMapFunctor> functorC(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorC), viewC);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 1);
+
+    PatternTree::Step& step = *(apt->begin());
+    auto team = teams.begin();
+    for (auto it = step.begin(); it != step.end(); ++it)
+    {
+        step.assign(*it, *team);
+        ++team;
+    }
+    ASSERT_EQ(step.teams().size(), 3);
+
+    std::vector<double> fieldA(64, 0.0);
+    std::vector<double> fieldB(64, 1.0);
+    std::vector<double> fieldC(64, 2.0);
+    apt->execute({{"fieldA", fieldA.data()}, {"fieldB", fieldB.data()}, {"fieldC", fieldC.data()}});
+
+    for (size_t i = 0; i < 64; i++)
+    {
+        ASSERT_EQ(fieldA[i], 1.0);
+        ASSERT_EQ(fieldB[i], 2.0);
+        ASSERT_EQ(fieldC[i], 3.0);
+    }
+}
+
+TEST(TestSuiteStepExecutor, TestSequentialSteps)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto matrix = PatternTree::APT::source<double**>("matrix", 64, 16);
+	auto sums = PatternTree::APT::source<double*>("sums", 64);
+
+    std::unique_ptr<RowSumMapFunctor> functorA(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functorA), sums);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), sums);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 2);
+
+    std::vector<double> values(64 * 16, 0.5);
+    std::vector<double> results(64, 0.0);
+    apt->execute({{"matrix", values.data()}, {"sums", results.data()}});
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        ASSERT_EQ(results[i], 9.0);
+    }
+}
+
+TEST(TestSuiteStepExecutor, TestOwnedStorage)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 16);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    apt->execute({});
+
+    ASSERT_FALSE(view->is_symbolic());
+    auto values = view->values();
+    for (size_t i = 0; i < 16; i++)
+    {
+        ASSERT_EQ(values(i), 1.0);
+    }
+
+    // Storage is kept across executions
+    apt->execute({});
+    for (size_t i = 0; i < 16; i++)
+    {
+        ASSERT_EQ(values(i), 2.0);
+    }
+}
+
+TEST(TestSuiteStepExecutor, TestLayoutLeft)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
+    PatternTree::APT::initialize(cluster);
+
+	auto matrix = PatternTree::APT::source<double**>("matrix", 8, 4);
+	auto sums = PatternTree::APT::source<double*>("sums", 8);
+    matrix->data().lock()->set_layout(PatternTree::IData::Layout::LEFT);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functor), sums);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Column-major: element (i, j) at j * 8 + i
+    std::vector<double> values(8 * 4);
+    for (size_t i = 0; i < 8; i++)
+    {
+        for (size_t j = 0; j < 4; j++)
+        {
+            values[j * 8 + i] = i;
+        }
+    }
+    std::vector<double> results(8, 0.0);
+    apt->execute({{"matrix", values.data()}, {"sums", results.data()}});
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        ASSERT_EQ(results[i], 4.0 * i);
+    }
+}
@@ -1,8 +1,35 @@
 #pragma once
 
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+
+#include <nlohmann/json.hpp>
+
 #include <data/view.h>
 #include <patterns/map.h>
+#include <patterns/reduce.h>
+#include <patterns/stencil.h>
 #include <api/arithmetic.h>
+#include <cluster/cluster.h>
+
+/**
+ * Cluster c18g parsed from a copy of the cluster descriptions in the directory,
+ * whose CPUs have the given memory bandwidth per core.
+ */
+inline std::shared_ptr<PatternTree::Cluster> memory_bandwidth_cluster(std::string directory, double bandwidth)
+{
+    std::filesystem::remove_all(directory);
+    std::filesystem::copy("../clusters", directory, std::filesystem::copy_options::recursive);
+
+    std::string cpu_path = directory + "/CPU/cpu_platinum_8160.json";
+    nlohmann::json cpu;
+    std::ifstream(cpu_path) >> cpu;
+    cpu["bandwidth"] = bandwidth;
+    std::ofstream(cpu_path) << cpu;
+
+    return PatternTree::Cluster::parse(directory + "/cluster_c18g.json");
+};
 
 struct DummyMapFunctor : public PatternTree::MapFunctor<double*> {
     void operator () (const int index, PatternTree::View<double*>& element) override {
@@ -79,6 +106,75 @@ struct CustomTriangleCostsMapFunctor : public PatternTree::MapFunctor<double**>
     }
 };
 
+struct MemoizedCostsMapFunctor : public PatternTree::MapFunctor<double*> {
+    inline static std::atomic<int> touches = 0;
+
+    void operator () (const int i, PatternTree::View<double*>& v) override
+    {
+        v = v + 1;
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {};
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        touches++;
+        info.flops = index + 1;
+
+        return true;
+    }
+
+    bool memoize() const override { return true; };
+};
+
+struct QuadraticCostsMapFunctor : public PatternTree::MapFunctor<double*> {
+    inline static std::atomic<int> touches = 0;
+
+    void operator () (const int i, PatternTree::View<double*>& v) override
+    {
+        for (int j = 0; j < i * i; j++)
+        {
+            v = v + 1;
+        }
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {};
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        touches++;
+        info.flops = index * index;
+
+        return true;
+    }
+};
+
+struct WeightedCostsMapFunctor : public PatternTree::MapFunctor<double*> {
+
+    WeightedCostsMapFunctor(size_t weight) : weight_(weight)
+    {}
+
+    void operator () (const int i, PatternTree::View<double*>& v) override
+    {
+        for (size_t j = 0; j < weight_; j++)
+        {
+            v = v + 1;
+        }
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {};
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        info.flops = weight_;
+
+        return true;
+    }
+
+private:
+    size_t weight_;
+};
+
 struct SplitMapFunctor : public PatternTree::MapFunctor<double*> {
     
     SplitMapFunctor(std::shared_ptr<PatternTree::View<double*>> second_view) : second_view_(second_view)
@@ -109,3 +205,69 @@ struct SplitMapFunctor : public PatternTree::MapFunctor<double*> {
 private:
     std::shared_ptr<PatternTree::View<double*>> second_view_;
 };
+
+struct ScaleMapFunctor : public PatternTree::MapFunctor<double*> {
+    
+    ScaleMapFunctor(std::shared_ptr<PatternTree::View<double*>> second_view) : second_view_(second_view)
+    {}
+    
+    void operator () (const int i, PatternTree::View<double*>& v) override
+    {
+        v = (*second_view_)(i);
+        v = 2.0 * v;
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {
+        dataflow.push_back(second_view_);
+    };
+
+private:
+    std::shared_ptr<PatternTree::View<double*>> second_view_;
+};
+
+struct RowSumMapFunctor : public PatternTree::MapFunctor<double*> {
+    
+    RowSumMapFunctor(std::shared_ptr<PatternTree::View<double**>> matrix) : matrix_(matrix)
+    {}
+    
+    void operator () (const int i, PatternTree::View<double*>& v) override
+    {
+        v = 0.0;
+        for (int j = 0; j < matrix_->shape()[1]; j++)
+        {
+            v = v + (*matrix_)(i, j);
+        }
+    };
+
+    void consumes(PatternTree::Dataflow& dataflow) override {
+        dataflow.push_back(matrix_);
+    };
+
+private:
+    std::shared_ptr<PatternTree::View<double**>> matrix_;
+};
+
+struct SumReduceFunctor : public PatternTree::ReduceFunctor<double*> {
+    double operator () (const double& lhs, const double& rhs) override
+    {
+        return lhs + rhs;
+    };
+};
+
+struct AverageStencilFunctor : public PatternTree::StencilFunctor<double*> {
+    void operator () (const int index, PatternTree::View<double*>& neighbourhood, PatternTree::View<double*>& element) override
+    {
+        double sum = 0.0;
+        for (int i = neighbourhood.begins()[0]; i < neighbourhood.ends()[0]; i++)
+        {
+            sum += neighbourhood(i);
+        }
+        element = sum / neighbourhood.elements();
+    };
+
+    bool touch(const int index, PatternTree::PatternIndexInfo &info) override
+    {
+        info.flops = 4;
+        return true;
+    };
+};
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <cluster/cluster.h>
+#include <optimization/stair_climbing_optimizer.h>
+#include <performance/roofline_model.h>
+
+#include "../helper.h"
+
+std::unique_ptr<PatternTree::APT> stair_climbing_apt(std::shared_ptr<PatternTree::Cluster> cluster)
+{
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 4096);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 4096);
+
+    for (int k = 0; k < 3; k++)
+    {
+        std::unique_ptr<ConstantCostsMapFunctor> functorA(new ConstantCostsMapFunctor());
+        PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorA), viewA);
+
+        std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+        PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), viewB);
+    }
+
+    return PatternTree::APT::compile();
+};
+
+TEST(TestSuiteStairClimbingOptimizer, TestComplete)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    auto apt = stair_climbing_apt(cluster);
+
+    ASSERT_EQ(apt->size(), 3);
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+
+    for (auto iter = apt->begin(); iter != apt->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+    }
+
+    PatternTree::RooflineModel model;
+    double costs = apt->evaluate(model);
+
+    ASSERT_NEAR(optimizer.costs(), costs, 1e-12);
+    ASSERT_GT(costs, 0.0);
+
+    // Not worse than mapping everything to a single processor
+    for (auto const& team : optimizer.teams())
+    {
+        for (auto iter = apt->begin(); iter != apt->end(); iter++)
+        {
+            for (auto it = iter->begin(); it != iter->end(); ++it)
+            {
+                iter->assign(*it, team);
+            }
+        }
+
+        PatternTree::RooflineModel baseline;
+        ASSERT_LE(costs, apt->evaluate(baseline) * (1.0 + 1e-9));
+    }
+};
+
+TEST(TestSuiteStairClimbingOptimizer, TestGranularity)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    auto apt = stair_climbing_apt(cluster);
+
+    PatternTree::StairClimbingOptimizer optimizer({1});
+    apt->optimize(optimizer);
+
+    for (auto iter = apt->begin(); iter != apt->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+        for (auto it = iter->begin(); it != iter->end(); ++it)
+        {
+            ASSERT_EQ(iter->splits(*it).size(), 1);
+        }
+    }
+};
+
+TEST(TestSuiteStairClimbingOptimizer, TestPeak)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    auto apt = stair_climbing_apt(cluster);
+
+    PatternTree::StairClimbingOptimizer optimizer({1, 2, 4}, PatternTree::RooflineModel::Variant::PEAK);
+    apt->optimize(optimizer);
+
+    for (auto iter = apt->begin(); iter != apt->end(); iter++)
+    {
+        ASSERT_TRUE(iter->complete());
+    }
+
+    PatternTree::RooflineModel model(PatternTree::RooflineModel::Variant::PEAK);
+    double costs = apt->evaluate(model);
+
+    ASSERT_NEAR(optimizer.costs(), costs, 1e-12);
+    ASSERT_EQ(model.report()["variant"], "peak");
+};
+
+TEST(TestSuiteStairClimbingOptimizer, TestSparseSamples)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+
+    // Few samples of quadratic costs, touching the bounds of the candidates refines the prefix sums
+    PatternTree::APT::initialize(cluster, 2, 2, true);
+	auto view = PatternTree::APT::source<double*>("field", 1000);
+    std::unique_ptr<QuadraticCostsMapFunctor> functor(new QuadraticCostsMapFunctor());
+    PatternTree::APT::map<double*, QuadraticCostsMapFunctor>(std::move(functor), view);
+    auto apt = PatternTree::APT::compile();
+
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
+
+    PatternTree::Step& step = *(apt->begin());
+    ASSERT_TRUE(step.complete());
+
+    // The splits of the best candidate cover the pattern without gaps
+    auto splits = step.splits(*(step.begin()));
+    std::sort(splits.begin(), splits.end(), [](const std::reference_wrapper<const PatternTree::PatternSplit>& a, const std::reference_wrapper<const PatternTree::PatternSplit>& b) {
+        return a.get().begin() < b.get().begin();
+    });
+    size_t end = 0;
+    for (auto const& split : splits)
+    {
+        ASSERT_EQ(split.get().begin(), end);
+        ASSERT_TRUE(step.assigned(split.get()).has_value());
+        end = split.get().end();
+    }
+    ASSERT_EQ(end, 1000);
+
+    PatternTree::RooflineModel model;
+    ASSERT_NEAR(optimizer.costs(), apt->evaluate(model), 1e-12);
+};
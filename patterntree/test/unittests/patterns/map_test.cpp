@@ -2,9 +2,13 @@
 
 #include <Kokkos_Core.hpp>
 
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <cluster/cluster.h>
 #include <data/data.h>
 #include <data/view.h>
 #include <patterns/map.h>
+#include <patterns/touch_cache.h>
 #include <api/arithmetic.h>
 
 #include "../helper.h"
@@ -122,3 +126,261 @@ TEST(TestSuiteMapFLOPS, TestInterpolate)
     ASSERT_EQ(map->flops(98, false), 199);
     ASSERT_EQ(map->flops(99, false), 201);
 };
+
+TEST(TestSuiteMapSubviews, TestElement)
+{
+	std::shared_ptr<PatternTree::Data<double*>> fieldA(new PatternTree::Data<double*>("fieldA", 1000));
+    std::shared_ptr<PatternTree::Data<double*>> fieldB(new PatternTree::Data<double*>("fieldB", 1000));
+
+    std::shared_ptr<PatternTree::View<double*>> viewA = PatternTree::View<double*>::full(fieldA);
+    std::shared_ptr<PatternTree::View<double*>> viewB = PatternTree::View<double*>::full(fieldB);
+
+    std::unique_ptr<ScaleMapFunctor> functor(new ScaleMapFunctor(viewB));
+    auto map = PatternTree::Map<double*>::create<ScaleMapFunctor>("scale", std::move(functor), viewA, 1);
+
+    auto subviewA = map->subflow_in(42, *fieldA);
+    ASSERT_EQ(subviewA->begins()[0], 42);
+    ASSERT_EQ(subviewA->ends()[0], 43);
+
+    auto subviewB = map->subflow_in(42, *fieldB);
+    ASSERT_EQ(subviewB->begins()[0], 42);
+    ASSERT_EQ(subviewB->ends()[0], 43);
+};
+
+TEST(TestSuiteMapSubviews, TestRow)
+{
+	std::shared_ptr<PatternTree::Data<double*>> field(new PatternTree::Data<double*>("field", 100));
+    std::shared_ptr<PatternTree::Data<double**>> matrix(new PatternTree::Data<double**>("matrix", 100, 50));
+
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(field);
+    std::shared_ptr<PatternTree::View<double**>> matrix_view = PatternTree::View<double**>::full(matrix);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix_view));
+    auto map = PatternTree::Map<double*>::create<RowSumMapFunctor>("row_sum", std::move(functor), view, 1);
+
+    auto subview = map->subflow_in(7, *matrix);
+    ASSERT_EQ(subview->begins(), std::vector<int>({7, 0}));
+    ASSERT_EQ(subview->ends(), std::vector<int>({8, 50}));
+
+    // Recording stops after touching
+    (*matrix_view)(0, 0);
+    ASSERT_EQ(matrix_view->accessed(), nullptr);
+};
+
+TEST(TestSuiteMapSubviews, TestNotAccessed)
+{
+	std::shared_ptr<PatternTree::Data<double*>> fieldA(new PatternTree::Data<double*>("fieldA", 1000));
+    std::shared_ptr<PatternTree::Data<double*>> fieldB(new PatternTree::Data<double*>("fieldB", 1000));
+
+    std::shared_ptr<PatternTree::View<double*>> viewA = PatternTree::View<double*>::full(fieldA);
+    std::shared_ptr<PatternTree::View<double*>> viewB = PatternTree::View<double*>::full(fieldB);
+
+    std::unique_ptr<TwoViewsMapFunctor> functor(new TwoViewsMapFunctor(viewB));
+    auto map = PatternTree::Map<double*>::create<TwoViewsMapFunctor>("dummy", std::move(functor), viewA, 1);
+
+    // Views without indexed accesses fall back to the consumed view
+    ASSERT_EQ(map->subflow_in(42, *fieldB), viewB);
+};
+
+TEST(TestSuiteMapSubviews, TestSplit)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 1000);
+	auto matrix = PatternTree::APT::source<double**>("matrix", 1000, 100);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functor), view, 10);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    PatternTree::Step& step = *(apt->begin());
+
+    // Each split reads only its rows of the matrix
+    auto splits = step.split(*(step.begin()), 4);
+    ASSERT_EQ(splits.size(), 4);
+    for (size_t i = 0; i < splits.size(); i++)
+    {
+        const PatternTree::PatternSplit& split = splits[i];
+        ASSERT_EQ(split.consumes()[1]->begins(), std::vector<int>({(int) i * 250, 0}));
+        ASSERT_EQ(split.consumes()[1]->ends(), std::vector<int>({(int) (i + 1) * 250, 100}));
+        ASSERT_EQ(split.consumes()[1]->kbytes(), matrix->kbytes() / 4);
+    }
+};
+
+TEST(TestSuiteMapBytes, TestRow)
+{
+	std::shared_ptr<PatternTree::Data<double*>> field(new PatternTree::Data<double*>("field", 100));
+    std::shared_ptr<PatternTree::Data<double**>> matrix(new PatternTree::Data<double**>("matrix", 100, 50));
+
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(field);
+    std::shared_ptr<PatternTree::View<double**>> matrix_view = PatternTree::View<double**>::full(matrix);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix_view));
+    auto map = PatternTree::Map<double*>::create<RowSumMapFunctor>("row_sum", std::move(functor), view, 1);
+
+    // Reads a row of the matrix, assigns the element once and accumulates into it for each column
+    double bytes = 50 * sizeof(double) + sizeof(double) + 50 * 2 * sizeof(double);
+    ASSERT_EQ(map->bytes(7, false), bytes);
+    ASSERT_EQ(map->bytes(), 100 * bytes);
+};
+
+TEST(TestSuiteMapBytes, TestIntensity)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 1000);
+	auto matrix = PatternTree::APT::source<double**>("matrix", 1000, 100);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functor), view, 10);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    PatternTree::Step& step = *(apt->begin());
+
+    auto splits = step.split(*(step.begin()), 4);
+    const PatternTree::PatternSplit& split = splits[0];
+
+    double bytes = 100 * sizeof(double) + sizeof(double) + 100 * 2 * sizeof(double);
+    ASSERT_EQ(split.bytes(), 250 * bytes);
+    ASSERT_EQ(split.arithmetic_intensity(), split.flops() / split.bytes());
+
+    // Without recorded bytes, the split is compute-bound
+    std::unique_ptr<ConstantCostsMapFunctor> constant(new ConstantCostsMapFunctor());
+    auto map = PatternTree::Map<double*>::create<ConstantCostsMapFunctor>("constant", std::move(constant), view, 1);
+    ASSERT_EQ(map->bytes(0, false), 2 * sizeof(double));
+};
+
+TEST(TestSuiteMapTouch, TestConcurrent)
+{
+	std::shared_ptr<PatternTree::Data<double**>> data(new PatternTree::Data<double**>("field", 100, 2));
+    std::shared_ptr<PatternTree::View<double**>> view = PatternTree::View<double**>::full(data);
+
+    std::unique_ptr<CustomTriangleCostsMapFunctor> functor(new CustomTriangleCostsMapFunctor());
+    auto map = PatternTree::Map<double**>::create<CustomTriangleCostsMapFunctor>("dummy", std::move(functor), view, 100);
+
+    for (int i = 0; i < 100; i++)
+    {
+        ASSERT_EQ(map->flops(i, false), 2 * i + 3);
+    }
+};
+
+TEST(TestSuiteMapTouch, TestSymbolicConcurrent)
+{
+	std::shared_ptr<PatternTree::Data<double*>> field(new PatternTree::Data<double*>("field", 100));
+    std::shared_ptr<PatternTree::Data<double**>> matrix(new PatternTree::Data<double**>("matrix", 100, 50));
+
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(field);
+    std::shared_ptr<PatternTree::View<double**>> matrix_view = PatternTree::View<double**>::full(matrix);
+
+    // Each index executes symbolically on the shared view of the matrix
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix_view));
+    auto map = PatternTree::Map<double*>::create<RowSumMapFunctor>("row_sum", std::move(functor), view, 100);
+
+    ASSERT_EQ(map->samples().size(), 100);
+    for (auto const& sample : map->samples())
+    {
+        int index = sample.first;
+        ASSERT_EQ(sample.second.flops, 50);
+        ASSERT_EQ(sample.second.bytes_read, 50 * sizeof(double));
+
+        auto subview = map->subflow_in(index, *matrix);
+        ASSERT_EQ(subview->begins(), std::vector<int>({index, 0}));
+        ASSERT_EQ(subview->ends(), std::vector<int>({index + 1, 50}));
+    }
+
+    // The view itself did not record
+    ASSERT_EQ(matrix_view->accessed(), nullptr);
+    ASSERT_EQ(matrix_view->accessed_bytes(), 0);
+};
+
+TEST(TestSuiteMapTouch, TestMemoize)
+{
+    PatternTree::TouchCache::instance().clear();
+    MemoizedCostsMapFunctor::touches = 0;
+
+	std::shared_ptr<PatternTree::Data<double*>> dataA(new PatternTree::Data<double*>("fieldA", 100));
+	std::shared_ptr<PatternTree::Data<double*>> dataB(new PatternTree::Data<double*>("fieldB", 100));
+	std::shared_ptr<PatternTree::Data<double*>> dataC(new PatternTree::Data<double*>("fieldC", 50));
+
+    std::unique_ptr<MemoizedCostsMapFunctor> functorA(new MemoizedCostsMapFunctor());
+    auto mapA = PatternTree::Map<double*>::create<MemoizedCostsMapFunctor>("A", std::move(functorA), PatternTree::View<double*>::full(dataA), 10);
+    ASSERT_EQ(MemoizedCostsMapFunctor::touches, 11);
+    ASSERT_EQ(PatternTree::TouchCache::instance().size(), 1);
+
+    // Same functor type and shapes
+    std::unique_ptr<MemoizedCostsMapFunctor> functorB(new MemoizedCostsMapFunctor());
+    auto mapB = PatternTree::Map<double*>::create<MemoizedCostsMapFunctor>("B", std::move(functorB), PatternTree::View<double*>::full(dataB), 10);
+    ASSERT_EQ(MemoizedCostsMapFunctor::touches, 11);
+    ASSERT_EQ(mapB->flops(), mapA->flops());
+    ASSERT_EQ(mapB->flops(99, false), 100);
+
+    // Different shape
+    std::unique_ptr<MemoizedCostsMapFunctor> functorC(new MemoizedCostsMapFunctor());
+    auto mapC = PatternTree::Map<double*>::create<MemoizedCostsMapFunctor>("C", std::move(functorC), PatternTree::View<double*>::full(dataC), 10);
+    ASSERT_EQ(MemoizedCostsMapFunctor::touches, 22);
+    ASSERT_EQ(PatternTree::TouchCache::instance().size(), 2);
+};
+
+TEST(TestSuiteMapTouch, TestSymbolicNotMemoized)
+{
+    PatternTree::TouchCache::instance().clear();
+
+	std::shared_ptr<PatternTree::Data<double*>> data(new PatternTree::Data<double*>("field", 100));
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(data);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+    auto map = PatternTree::Map<double*>::create<ConstantCostsMapFunctor>("constant", std::move(functor), view, 10);
+
+    ASSERT_EQ(map->flops(50, false), 1);
+    ASSERT_EQ(PatternTree::TouchCache::instance().size(), 0);
+};
+
+TEST(TestSuiteMapRefinement, TestRangeFlops)
+{
+	std::shared_ptr<PatternTree::Data<double**>> data(new PatternTree::Data<double**>("field", 100, 2));
+    std::shared_ptr<PatternTree::View<double**>> view = PatternTree::View<double**>::full(data);
+
+    std::unique_ptr<CustomTriangleCostsMapFunctor> functor(new CustomTriangleCostsMapFunctor());
+    auto map = PatternTree::Map<double**>::create<CustomTriangleCostsMapFunctor>("dummy", std::move(functor), view, 4);
+
+    double flops = 0.0;
+    for (int i = 13; i < 77; i++)
+    {
+        flops += 2 * i + 3;
+    }
+
+    ASSERT_DOUBLE_EQ(map->range_flops(13, 77), flops);
+    ASSERT_DOUBLE_EQ(map->range_flops(42, 43), map->flops(42, false));
+    ASSERT_DOUBLE_EQ(map->range_flops(0, 100), map->flops());
+    ASSERT_EQ(map->range_flops(50, 50), 0.0);
+};
+
+TEST(TestSuiteMapRefinement, TestQuadratic)
+{
+    QuadraticCostsMapFunctor::touches = 0;
+
+	std::shared_ptr<PatternTree::Data<double*>> data(new PatternTree::Data<double*>("field", 1000));
+    std::shared_ptr<PatternTree::View<double*>> view = PatternTree::View<double*>::full(data);
+
+    std::unique_ptr<QuadraticCostsMapFunctor> functor(new QuadraticCostsMapFunctor());
+    auto map = PatternTree::Map<double*>::create<QuadraticCostsMapFunctor>("quadratic", std::move(functor), view, 4);
+
+    // 5 samples and a budget of 4 refinements
+    ASSERT_EQ(QuadraticCostsMapFunctor::touches, 9);
+
+    double flops = 999.0 * 1000.0 * 1999.0 / 6.0;
+    double error = std::abs(map->flops() - flops) / flops;
+
+    map->refine(100);
+    ASSERT_GT(QuadraticCostsMapFunctor::touches, 9);
+    ASSERT_LE(QuadraticCostsMapFunctor::touches, 109);
+
+    double refined_error = std::abs(map->flops() - flops) / flops;
+    ASSERT_LT(refined_error, error);
+    ASSERT_LT(refined_error, 0.01);
+
+    // Refined where the interpolation deviates
+    ASSERT_NEAR(map->flops(100, false), 100 * 100, 0.05 * 100 * 100);
+};
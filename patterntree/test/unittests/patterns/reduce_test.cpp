@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Kokkos_Core.hpp>
+
+#include <data/data.h>
+#include <data/view.h>
+#include <patterns/reduce.h>
+
+#include "../helper.h"
+
+TEST(TestSuiteReduce, TestDataflow)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> result(new PatternTree::Data<double*>("result", 1));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::full(input);
+    std::shared_ptr<PatternTree::View<double*>> result_view = PatternTree::View<double*>::full(result);
+
+    std::unique_ptr<SumReduceFunctor> functor(new SumReduceFunctor());
+    auto reduce = PatternTree::Reduce<double*>::create<SumReduceFunctor>("sum", std::move(functor), input_view, result_view, 1);
+
+    ASSERT_EQ(reduce->width(), 1000);
+    ASSERT_EQ(reduce->flops(), 1000);
+
+    ASSERT_EQ(reduce->consumes().size(), 2);
+    ASSERT_EQ(reduce->consumes().at(0), input_view);
+    ASSERT_EQ(reduce->consumes().at(1), result_view);
+
+    ASSERT_EQ(reduce->produces().size(), 1);
+    ASSERT_EQ(reduce->produces().at(0), result_view);
+};
+
+TEST(TestSuiteReduce, TestSubflow)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> result(new PatternTree::Data<double*>("result", 1));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::slice(input, std::make_pair(100, 200));
+    std::shared_ptr<PatternTree::View<double*>> result_view = PatternTree::View<double*>::full(result);
+
+    std::unique_ptr<SumReduceFunctor> functor(new SumReduceFunctor());
+    auto reduce = PatternTree::Reduce<double*>::create<SumReduceFunctor>("sum", std::move(functor), input_view, result_view, 1);
+
+    ASSERT_EQ(reduce->width(), 100);
+
+    // Indices are relative to the input view
+    auto subview = reduce->subflow_in(5, *input);
+    ASSERT_EQ(subview->begins()[0], 105);
+    ASSERT_EQ(subview->ends()[0], 106);
+
+    ASSERT_EQ(reduce->subflow_in(5, *result), result_view);
+    ASSERT_EQ(reduce->subflow_out(5), result_view);
+};
+
+TEST(TestSuiteReduce, TestExecute)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> result(new PatternTree::Data<double*>("result", 1));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::slice(input, std::make_pair(100, 1000));
+    std::shared_ptr<PatternTree::View<double*>> result_view = PatternTree::View<double*>::full(result);
+
+    std::unique_ptr<SumReduceFunctor> functor(new SumReduceFunctor());
+    auto reduce = PatternTree::Reduce<double*>::create<SumReduceFunctor>("sum", std::move(functor), input_view, result_view, 1);
+
+    std::vector<double> input_values(1000);
+    for (size_t i = 0; i < input_values.size(); i++)
+    {
+        input_values[i] = i;
+    }
+    double result_value = 1.0;
+
+    input->bind(input_values.data());
+    result->bind(&result_value);
+
+    // Partial reductions of the splits are combined into the result
+    reduce->execute(0, 300);
+    reduce->execute(300, 899);
+    reduce->execute(899, 900);
+
+    ASSERT_EQ(result_value, 1.0 + (999.0 * 1000.0 - 99.0 * 100.0) / 2.0);
+};
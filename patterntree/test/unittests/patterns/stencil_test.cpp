@@ -0,0 +1,134 @@
+#pragma once
+
+#include <Kokkos_Core.hpp>
+
+#include <apt/apt.h>
+#include <apt/step.h>
+#include <data/data.h>
+#include <data/view.h>
+#include <patterns/stencil.h>
+
+#include "../helper.h"
+
+TEST(TestSuiteStencil, TestDataflow)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> output(new PatternTree::Data<double*>("output", 1000));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::full(input);
+    std::shared_ptr<PatternTree::View<double*>> output_view = PatternTree::View<double*>::full(output);
+
+    std::unique_ptr<AverageStencilFunctor> functor(new AverageStencilFunctor());
+    auto stencil = PatternTree::Stencil<double*>::create<AverageStencilFunctor>("average", std::move(functor), input_view, output_view, 2, 1);
+
+    ASSERT_EQ(stencil->width(), 1000);
+    ASSERT_EQ(stencil->radius(), 2);
+    ASSERT_EQ(stencil->flops(), 4000);
+
+    ASSERT_EQ(stencil->consumes().size(), 1);
+    ASSERT_EQ(stencil->consumes().at(0), input_view);
+
+    ASSERT_EQ(stencil->produces().size(), 1);
+    ASSERT_EQ(stencil->produces().at(0), output_view);
+};
+
+TEST(TestSuiteStencil, TestAliased)
+{
+	std::shared_ptr<PatternTree::Data<double*>> field(new PatternTree::Data<double*>("field", 1000));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::slice(field, std::make_pair(0, 500));
+    std::shared_ptr<PatternTree::View<double*>> output_view = PatternTree::View<double*>::slice(field, std::make_pair(500, 1000));
+
+    // Splits would read the rows written by their neighbours
+    std::unique_ptr<AverageStencilFunctor> functor(new AverageStencilFunctor());
+    auto stencil = PatternTree::Stencil<double*>::create<AverageStencilFunctor>("average", std::move(functor), input_view, output_view, 1, 1);
+    ASSERT_EQ(stencil, nullptr);
+
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::APT::initialize(cluster);
+	auto u = PatternTree::APT::source<double*>("u", 1000);
+    std::unique_ptr<AverageStencilFunctor> average(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(average), u, u, 1);
+    auto apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 0);
+};
+
+TEST(TestSuiteStencil, TestHalo)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> output(new PatternTree::Data<double*>("output", 1000));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::full(input);
+    std::shared_ptr<PatternTree::View<double*>> output_view = PatternTree::View<double*>::full(output);
+
+    std::unique_ptr<AverageStencilFunctor> functor(new AverageStencilFunctor());
+    auto stencil = PatternTree::Stencil<double*>::create<AverageStencilFunctor>("average", std::move(functor), input_view, output_view, 2, 1);
+
+    auto first = stencil->subflow_in(0, *input);
+    ASSERT_EQ(first->begins()[0], 0);
+    ASSERT_EQ(first->ends()[0], 3);
+
+    auto middle = stencil->subflow_in(500, *input);
+    ASSERT_EQ(middle->begins()[0], 498);
+    ASSERT_EQ(middle->ends()[0], 503);
+
+    auto last = stencil->subflow_in(999, *input);
+    ASSERT_EQ(last->begins()[0], 997);
+    ASSERT_EQ(last->ends()[0], 1000);
+
+    auto element = stencil->subflow_out(500);
+    ASSERT_EQ(element->begins()[0], 500);
+    ASSERT_EQ(element->ends()[0], 501);
+};
+
+TEST(TestSuiteStencil, TestSplit)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    PatternTree::APT::initialize(cluster);
+
+	auto input = PatternTree::APT::source<double*>("input", 1000);
+	auto output = PatternTree::APT::source<double*>("output", 1000);
+
+    std::unique_ptr<AverageStencilFunctor> functor(new AverageStencilFunctor());
+    PatternTree::APT::stencil<double*, AverageStencilFunctor>(std::move(functor), input, output, 2, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    PatternTree::Step& step = *(apt->begin());
+
+    // Splits consume their range plus the halo
+    auto splits = step.split(*(step.begin()), 4);
+    ASSERT_EQ(splits.size(), 4);
+
+    const PatternTree::PatternSplit& split = splits[1];
+    ASSERT_EQ(split.consumes()[0]->begins()[0], 248);
+    ASSERT_EQ(split.consumes()[0]->ends()[0], 502);
+    ASSERT_EQ(split.produces()[0]->begins()[0], 250);
+    ASSERT_EQ(split.produces()[0]->ends()[0], 500);
+};
+
+TEST(TestSuiteStencil, TestExecute)
+{
+	std::shared_ptr<PatternTree::Data<double*>> input(new PatternTree::Data<double*>("input", 1000));
+	std::shared_ptr<PatternTree::Data<double*>> output(new PatternTree::Data<double*>("output", 1000));
+    std::shared_ptr<PatternTree::View<double*>> input_view = PatternTree::View<double*>::full(input);
+    std::shared_ptr<PatternTree::View<double*>> output_view = PatternTree::View<double*>::slice(output, std::make_pair(10, 1000));
+
+    std::unique_ptr<AverageStencilFunctor> functor(new AverageStencilFunctor());
+    auto stencil = PatternTree::Stencil<double*>::create<AverageStencilFunctor>("average", std::move(functor), PatternTree::View<double*>::slice(input, std::make_pair(0, 990)), output_view, 1, 1);
+
+    std::vector<double> input_values(1000);
+    std::vector<double> output_values(1000, -1.0);
+    for (size_t i = 0; i < input_values.size(); i++)
+    {
+        input_values[i] = i;
+    }
+
+    input->bind(input_values.data());
+    output->bind(output_values.data());
+
+    stencil->execute(0, 990);
+
+    // Rows of the output are shifted by the begin of the output view
+    ASSERT_EQ(output_values[9], -1.0);
+    ASSERT_EQ(output_values[10], 0.5);
+    ASSERT_EQ(output_values[11], 1.0);
+    ASSERT_EQ(output_values[500], 490.0);
+    ASSERT_EQ(output_values[999], 989.0);
+};
@@ -239,3 +239,110 @@ TEST(TestSuiteDataflowState, TestSubviews)
         i++;
     }
 }
+
+TEST(TestSuiteDataflowState, TestSharedRead)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processorA = device->processors().find("1")->second;
+    std::shared_ptr<PatternTree::Processor> processorB = device->processors().find("2")->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(processorA, 1));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team(processorB, 1));
+
+    // BEGIN APT
+
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 32);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 32);
+	auto viewC = PatternTree::APT::source<double*>("fieldC", 32);
+
+    std::unique_ptr<TwoViewsMapFunctor> functorA(new TwoViewsMapFunctor(viewA));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functorA), viewB);
+    
+    std::unique_ptr<TwoViewsMapFunctor> functorB(new TwoViewsMapFunctor(viewA));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functorB), viewC);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // END APT
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& mapA = *(step.begin());
+    PatternTree::IPattern& mapB = *(++(step.begin()));
+
+    step.assign(mapA, teamA);
+    step.assign(mapB, teamB);
+
+    PatternTree::DataflowState state;
+    state.update(step);
+
+    ASSERT_EQ(state.owns(teamA->processor()).size(), 2);
+    ASSERT_EQ(state.owns(teamB->processor()).size(), 2);
+
+    auto owners = state.owned_by(*viewA);
+    ASSERT_EQ(owners.size(), 2);
+
+    std::set<const PatternTree::Processor*> processors;
+    for (auto const& entry : owners)
+    {
+        processors.insert(entry.second);
+    }
+    ASSERT_TRUE(processors.find(&(teamA->processor())) != processors.end());
+    ASSERT_TRUE(processors.find(&(teamB->processor())) != processors.end());
+
+    ASSERT_EQ(state.owned_by(*viewB).begin()->second, &(teamA->processor()));
+    ASSERT_EQ(state.owned_by(*viewC).begin()->second, &(teamB->processor()));
+}
+
+TEST(TestSuiteDataflowState, TestUndo)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().begin()->second;
+    std::shared_ptr<PatternTree::Processor> processorA = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Processor> processorB = (++(device->processors().begin()))->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(processorA, 1));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team(processorB, 1));
+
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto viewA = PatternTree::APT::source<double*>("fieldA", 36);
+	auto viewB = PatternTree::APT::source<double*>("fieldB", 36);
+
+    std::unique_ptr<TwoViewsMapFunctor> functorA(new TwoViewsMapFunctor(viewB));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functorA), viewA);
+
+    std::unique_ptr<TwoViewsMapFunctor> functorB(new TwoViewsMapFunctor(viewA));
+    PatternTree::APT::map<double*, TwoViewsMapFunctor>(std::move(functorB), viewB);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    ASSERT_EQ(apt->size(), 2);
+
+    PatternTree::Step& first = *(apt->begin());
+    PatternTree::Step& second = *(++(apt->begin()));
+    first.assign(*(first.begin()), teamA);
+    second.assign(*(second.begin()), teamB);
+
+    PatternTree::DataflowState state;
+    state.update(first);
+    auto ownersA = state.owned_by(*viewA);
+    auto ownersB = state.owned_by(*viewB);
+
+    // Reading and overwriting the data of the first step is reverted
+    auto mark = state.mark();
+    state.update(second);
+    ASSERT_EQ(state.index(), 2);
+    ASSERT_EQ(state.owns(teamB->processor()).size(), 4);
+
+    state.undo(mark);
+    ASSERT_EQ(state.index(), 1);
+    ASSERT_EQ(state.owns(teamB->processor()).size(), 0);
+    ASSERT_EQ(state.owned_by(*viewA), ownersA);
+    ASSERT_EQ(state.owned_by(*viewB), ownersB);
+
+    // The next step updates the reverted state
+    state.update(second);
+    ASSERT_EQ(state.index(), 2);
+};
@@ -68,9 +68,12 @@ TEST(TestSuiteRooflineExecutionCosts, TestConstant)
     PatternTree::RooflineModel model;
     double costs = model.execution_costs(step.splits(map), *team);
 
+    // Below the ridge point, 1 FLOP per 16 bytes is bound by the memory of the device
     double expected_costs = 100 * 1;
     expected_costs /= processor->frequency() * PatternTree::IPerformanceModel::FREQUENCY_TO_SECONDS; 
-    ASSERT_EQ(costs, expected_costs);
+    double bandwidth = std::min(device->memory_bandwidth(), device->memory_max_bandwidth()) * PatternTree::IPerformanceModel::BANDWIDTH_TO_SECONDS * 1000.0;
+    ASSERT_DOUBLE_EQ(costs, std::max(expected_costs, map.bytes() / bandwidth));
+    ASSERT_GT(costs, expected_costs);
 };
 
 TEST(TestSuiteRooflineExecutionCosts, TestTriangle)
@@ -100,7 +103,8 @@ TEST(TestSuiteRooflineExecutionCosts, TestTriangle)
 
     double expected_costs = (2 + 200) * 50;
     expected_costs /= processor->frequency() * PatternTree::IPerformanceModel::FREQUENCY_TO_SECONDS; 
-    ASSERT_EQ(costs, expected_costs);
+    double bandwidth = std::min(device->memory_bandwidth(), device->memory_max_bandwidth()) * PatternTree::IPerformanceModel::BANDWIDTH_TO_SECONDS * 1000.0;
+    ASSERT_DOUBLE_EQ(costs, std::max(expected_costs, map.bytes() / bandwidth));
 };
 
 
@@ -252,3 +256,408 @@ TEST(TestSuiteRooflineNetworkCosts, TestSharedData)
 
     ASSERT_NEAR(costs, expected_costs, 0.000001);
 };
+
+TEST(TestSuiteRooflineDelta, TestEvaluateDelta)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> nodeA = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Node> nodeB = (++(cluster->nodes().begin()))->second;
+    std::shared_ptr<PatternTree::Device> deviceA = nodeA->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Device> deviceB = nodeB->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team((deviceA->processors().begin())->second, 1));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team((deviceB->processors().begin())->second, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorA(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorA), view, 100);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorB(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorB), view, 100);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functorC(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functorC), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Conditions
+
+    for (auto iter = apt->begin(); iter != apt->end(); iter++)
+    {
+        iter->assign(*(iter->begin()), teamA);
+    }
+
+    PatternTree::RooflineModel reference;
+    double costs = apt->evaluate(reference);
+
+    PatternTree::RooflineModel model;
+    model.update(*(apt->begin()));
+
+    auto next = ++(apt->begin());
+    PatternTree::Step& step = *next;
+    const PatternTree::PatternSplit& split = step.splits()[0];
+
+    double before = model.costs();
+    double remaining = model.evaluate(next, apt->end());
+    ASSERT_NEAR(before + remaining, costs, 1e-12);
+
+    double delta = model.evaluate_delta(next, apt->end(), split, teamB);
+
+    ASSERT_EQ(model.costs(), before);
+    ASSERT_EQ(step.assigned(split).value(), teamA);
+
+    step.assign(split, teamB);
+    PatternTree::RooflineModel moved;
+    double moved_costs = apt->evaluate(moved);
+
+    ASSERT_GT(delta, 0.0);
+    ASSERT_NEAR(costs + delta, moved_costs, 1e-12);
+};
+
+TEST(TestSuiteRooflineDelta, TestTeamCosts)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team((device->processors().begin())->second, 4));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+
+    std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+    PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    auto splits = step.split(*(step.begin()), 4);
+
+    const PatternTree::RooflineModel model;
+    double costs = model.costs(splits, *team);
+
+    ASSERT_EQ(costs, model.execution_costs(splits, *team) + model.network_costs(splits, *team));
+
+    step.assign(*(step.begin()), team);
+
+    PatternTree::RooflineModel reference;
+    reference.update(step);
+
+    ASSERT_EQ(costs, reference.costs());
+};
+
+TEST(TestSuiteRooflineCombine, TestCombineCosts)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> nodeA = cluster->nodes().find("Node1")->second;
+    std::shared_ptr<PatternTree::Node> nodeB = cluster->nodes().find("Node2")->second;
+    std::shared_ptr<PatternTree::Device> deviceA = nodeA->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Device> deviceB = nodeB->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(deviceA->processors().find("1")->second, 1));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team(deviceA->processors().find("2")->second, 1));
+    std::shared_ptr<PatternTree::Team> teamC(new PatternTree::Team(deviceB->processors().find("1")->second, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto input = PatternTree::APT::source<double*>("input", 100);
+	auto result = PatternTree::APT::source<double*>("result", 1);
+
+    std::unique_ptr<SumReduceFunctor> functor(new SumReduceFunctor());
+    PatternTree::APT::reduce<double*, SumReduceFunctor>(std::move(functor), input, result, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    const PatternTree::IReduce& reduce = dynamic_cast<const PatternTree::IReduce&>(*(step.begin()));
+
+    const PatternTree::RooflineModel model;
+    ASSERT_EQ(model.combine_costs(reduce, {teamA.get()}), 0.0);
+
+    double device_costs = model.combine_costs(reduce, {teamA.get(), teamB.get()});
+    double cluster_costs = model.combine_costs(reduce, {teamA.get(), teamC.get()});
+    ASSERT_GT(device_costs, 0.0);
+    ASSERT_GT(cluster_costs, device_costs);
+
+    // The teams on the same device are combined first, then across the nodes
+    double tree_costs = model.combine_costs(reduce, {teamC.get(), teamA.get(), teamB.get()});
+    ASSERT_NEAR(tree_costs, device_costs + model.combine_costs(reduce, {teamA.get(), teamC.get()}), 1e-15);
+
+    // Splits across teams add the combine costs to the step
+    auto splits = step.split(*(step.begin()), 2);
+    step.assign(splits[0], teamA);
+    step.assign(splits[1], teamC);
+
+    PatternTree::RooflineModel split_model;
+    split_model.update(step);
+
+    double exec_costs = std::max(model.costs({splits[0]}, *teamA), model.costs({splits[1]}, *teamC));
+    ASSERT_NEAR(split_model.costs(), exec_costs + cluster_costs, 1e-15);
+};
+
+TEST(TestSuiteRooflineExecutionCosts, TestMemoryBound)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processor = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+	auto matrix = PatternTree::APT::source<double**>("matrix", 100, 50);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functor), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    PatternTree::RooflineModel model;
+    double costs = model.execution_costs(step.splits(map), *team);
+
+    // 50 FLOPS per 1208 bytes are below the ridge point of the processor
+    double bandwidth = std::min(device->memory_bandwidth(), device->memory_max_bandwidth()) * PatternTree::IPerformanceModel::BANDWIDTH_TO_SECONDS * 1000.0;
+    double expected_costs = 100 * 1208 / bandwidth;
+    ASSERT_DOUBLE_EQ(costs, expected_costs);
+    ASSERT_GT(costs, 100 * 50 / (processor->frequency() * PatternTree::IPerformanceModel::FREQUENCY_TO_SECONDS));
+};
+
+TEST(TestSuiteRooflinePeak, TestPeakFlops)
+{
+    std::shared_ptr<PatternTree::Processor> processor = PatternTree::Processor::parse("../clusters/CPU/socket_platinum_8160.json");
+
+    PatternTree::RooflineModel scalar;
+    PatternTree::RooflineModel peak(PatternTree::RooflineModel::Variant::PEAK);
+
+    double frequency = processor->frequency() * PatternTree::IPerformanceModel::FREQUENCY_TO_SECONDS;
+    ASSERT_EQ(scalar.peak_flops(*processor, 2), 2 * frequency);
+    
+    // 4 arithmetic units, 8 lanes of avx512 and FMA
+    ASSERT_EQ(peak.peak_flops(*processor, 2), 2 * 4 * 8 * 2 * frequency);
+};
+
+TEST(TestSuiteRooflinePeak, TestComputeBound)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processor = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double**>("field", 100, 2);
+
+    std::unique_ptr<CustomTriangleCostsMapFunctor> functor(new CustomTriangleCostsMapFunctor());
+    PatternTree::APT::map<double**, CustomTriangleCostsMapFunctor>(std::move(functor), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    PatternTree::RooflineModel scalar;
+    PatternTree::RooflineModel peak(PatternTree::RooflineModel::Variant::PEAK);
+
+    // Without bytes, the costs scale with the peak of the processor
+    double costs = peak.execution_costs(step.splits(map), *team);
+    ASSERT_DOUBLE_EQ(costs, scalar.execution_costs(step.splits(map), *team) / (4 * 8 * 2));
+};
+
+TEST(TestSuiteRooflinePeak, TestMemoryBound)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processor = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+	auto matrix = PatternTree::APT::source<double**>("matrix", 100, 50);
+
+    std::unique_ptr<RowSumMapFunctor> functor(new RowSumMapFunctor(matrix));
+    PatternTree::APT::map<double*, RowSumMapFunctor>(std::move(functor), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    PatternTree::RooflineModel scalar;
+    PatternTree::RooflineModel peak(PatternTree::RooflineModel::Variant::PEAK);
+
+    // Bound by the bandwidth in both variants
+    double costs = peak.execution_costs(step.splits(map), *team);
+    ASSERT_DOUBLE_EQ(costs, scalar.execution_costs(step.splits(map), *team));
+};
+
+TEST(TestSuiteRooflinePeak, TestOverlap)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> node = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Device> device = node->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Processor> processor = (device->processors().begin())->second;
+    std::shared_ptr<PatternTree::Team> team(new PatternTree::Team(processor, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double**>("field", 100, 2);
+
+    std::unique_ptr<TriangleCostsMapFunctor> functor(new TriangleCostsMapFunctor());
+    PatternTree::APT::map<double**, TriangleCostsMapFunctor>(std::move(functor), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    
+    // Conditions
+
+    PatternTree::Step& step = *(apt->begin());
+    PatternTree::IPattern& map = *(step.begin());
+
+    PatternTree::RooflineModel scalar;
+    PatternTree::RooflineModel peak(PatternTree::RooflineModel::Variant::PEAK);
+
+    double exec_costs = peak.execution_costs(step.splits(map), *team);
+    double net_costs = peak.network_costs(step.splits(map), *team);
+    ASSERT_GT(exec_costs, 0.0);
+    ASSERT_GT(net_costs, 0.0);
+
+    ASSERT_DOUBLE_EQ(peak.costs(step.splits(map), *team), std::max(exec_costs, net_costs));
+    double scalar_costs = scalar.execution_costs(step.splits(map), *team) + scalar.network_costs(step.splits(map), *team);
+    ASSERT_DOUBLE_EQ(scalar.costs(step.splits(map), *team), scalar_costs);
+};
+
+TEST(TestSuiteRooflineNetworkCosts, TestLinkContention)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g_fat_tree.json");
+    auto processor = [&](std::string node) {
+        return cluster->nodes().at(node)->devices().at("CPU1")->processors().begin()->second;
+    };
+
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team(processor("Node1"), 1));
+    std::shared_ptr<PatternTree::Team> teamC(new PatternTree::Team(processor("Node3"), 1));
+    std::shared_ptr<PatternTree::Team> teamD(new PatternTree::Team(processor("Node4"), 1));
+
+    PatternTree::APT::initialize(cluster, 2, 32, true);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+
+    std::unique_ptr<DummyMapFunctor> functorA(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functorA), view, 100);
+
+    std::unique_ptr<DummyMapFunctor> functorB(new DummyMapFunctor());
+    PatternTree::APT::map<double*, DummyMapFunctor>(std::move(functorB), view, 100);
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    
+    // Conditions
+
+    PatternTree::Step& stepA = *(apt->begin());
+    PatternTree::IPattern& mapA = *(stepA.begin());
+    stepA.assign(mapA, teamA);
+
+    PatternTree::RooflineModel model;
+    model.update(stepA);
+
+    PatternTree::Step& stepB = *(++(apt->begin()));
+    PatternTree::IPattern& mapB = *(stepB.begin());
+    auto splits = stepB.split(mapB, 2);
+
+    // Both halves are pulled from Node1 through its uplink and the root
+    std::vector<const PatternTree::Team*> teams = { teamC.get(), teamD.get() };
+    std::vector<PatternTree::RooflineModel::Transfers> transfers = {
+        model.transfers({ splits[0] }, *teamC),
+        model.transfers({ splits[1] }, *teamD)
+    };
+    auto loads = model.link_loads(transfers, teams);
+    ASSERT_EQ(loads.size(), 5);
+
+    double latency = 3680.0 / PatternTree::RooflineModel::LATENCY_TO_SECONDS;
+    ASSERT_EQ(transfers[0].kbytes.size(), 1);
+    ASSERT_EQ(transfers[0].kbytes.begin()->first, &(teamA->processor()));
+    double kbytes = transfers[0].kbytes.begin()->second;
+
+    double exclusive_costs = model.network_costs(transfers[0], *teamC, nullptr);
+    ASSERT_NEAR(exclusive_costs, latency + kbytes / (4148.0 * PatternTree::RooflineModel::BANDWIDTH_TO_SECONDS), 1e-12);
+
+    double shared_costs = model.network_costs(transfers[0], *teamC, &loads);
+    ASSERT_NEAR(shared_costs, latency + kbytes / (2074.0 * PatternTree::RooflineModel::BANDWIDTH_TO_SECONDS), 1e-12);
+
+    // Concurrent costs of the step include the contention
+    std::vector<PatternTree::RooflineModel::Splits> groups = { { splits[0] }, { splits[1] } };
+    auto costs = model.costs(groups, teams);
+    ASSERT_GT(costs[0], model.costs({ splits[0] }, *teamC));
+};
+
+TEST(TestSuiteRooflineDelta, TestDeltaWindow)
+{
+    std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
+    std::shared_ptr<PatternTree::Node> nodeA = cluster->nodes().begin()->second;
+    std::shared_ptr<PatternTree::Node> nodeB = (++(cluster->nodes().begin()))->second;
+    std::shared_ptr<PatternTree::Device> deviceA = nodeA->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Device> deviceB = nodeB->devices().find("CPU1")->second;
+    std::shared_ptr<PatternTree::Team> teamA(new PatternTree::Team((deviceA->processors().begin())->second, 1));
+    std::shared_ptr<PatternTree::Team> teamB(new PatternTree::Team((deviceB->processors().begin())->second, 1));
+
+    PatternTree::APT::initialize(cluster);
+
+	auto view = PatternTree::APT::source<double*>("field", 100);
+    for (int k = 0; k < 4; k++)
+    {
+        std::unique_ptr<ConstantCostsMapFunctor> functor(new ConstantCostsMapFunctor());
+        PatternTree::APT::map<double*, ConstantCostsMapFunctor>(std::move(functor), view, 100);
+    }
+
+    std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
+    for (auto iter = apt->begin(); iter != apt->end(); iter++)
+    {
+        iter->assign(*(iter->begin()), teamA);
+    }
+
+    PatternTree::RooflineModel model;
+    model.update(*(apt->begin()));
+
+    auto next = ++(apt->begin());
+    PatternTree::Step& step = *next;
+    const PatternTree::PatternSplit& split = step.splits()[0];
+
+    // Window of the moved step and its successor
+    double before = model.costs();
+    double delta = model.evaluate_delta(next, apt->end(), split, teamB, 2);
+    ASSERT_EQ(model.costs(), before);
+    ASSERT_EQ(step.assigned(split).value(), teamA);
+
+    double costs = model.evaluate(next, apt->end());
+    PatternTree::RooflineModel window;
+    window.update(*(apt->begin()));
+    window.update(*next);
+    window.update(*(++(++(apt->begin()))));
+    double window_costs = window.costs() - before;
+
+    step.assign(split, teamB);
+    PatternTree::RooflineModel moved;
+    moved.update(*(apt->begin()));
+    moved.update(*next);
+    moved.update(*(++(++(apt->begin()))));
+    double moved_costs = moved.costs() - before;
+
+    ASSERT_GT(delta, 0.0);
+    ASSERT_NEAR(window_costs + delta, moved_costs, 1e-12);
+    ASSERT_LT(window_costs, costs);
+};
@@ -6,10 +6,13 @@
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
 
+#include <Kokkos_Core.hpp>
+
 struct JacobiFunctor : public PatternTree::MapFunctor<double*> {
     JacobiFunctor(std::shared_ptr<PatternTree::View<double**>> A, std::shared_ptr<PatternTree::View<double*>> b, std::shared_ptr<PatternTree::View<double*>> x_)
     : A(A), b(b), x_(x_)
@@ -52,7 +55,9 @@ private:
     std::shared_ptr<PatternTree::View<double*>> x_;
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    Kokkos::ScopeGuard kokkos(argc, argv);
+
 	std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
     
 	// BEGIN APT
@@ -78,13 +83,20 @@ int main() {
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 
 	// Optimize and map
-    //PatternTree::StairClimbingOptimizer optimizer;
-    //apt->optimize(optimizer);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
 
 	// Evaluate estimated runtime
-    //PatternTree::RooflineModel model;
-    //double runtime = apt->evaluate(model);
-
-	// TODO: Execute
-	// apt->execute()
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
+
+	// Execute
+    std::vector<double> A_values(N * N, 1.0);
+    std::vector<double> b_values(N, 1.0);
+    std::vector<double> x_values(N, 0.0);
+    std::vector<double> x__values(N, 0.0);
+    for (int i = 0; i < N; i++) {
+        A_values[i * N + i] = 2.0 * N;
+    }
+    apt->execute({{"A", A_values.data()}, {"b", b_values.data()}, {"x", x_values.data()}, {"x_", x__values.data()}});
 }
\ No newline at end of file
@@ -6,12 +6,15 @@
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
 
 #include <data/data_concepts.h>
 
+#include <Kokkos_Core.hpp>
+
 struct KMeansAssignFunctor : public PatternTree::MapFunctor<int*> {
 
     KMeansAssignFunctor(std::shared_ptr<PatternTree::View<double**>> points, std::shared_ptr<PatternTree::View<double**>> centroids)
@@ -21,8 +24,8 @@ struct KMeansAssignFunctor : public PatternTree::MapFunctor<int*> {
     void operator () (int index, PatternTree::View<int*>& assignment) override {
         double optimal_dist = DBL_MAX;
         for (int k = 0; k < centroids_->shape()[0]; ++k) {
-            double x_dist = (*points_)(index, 0) - (*centroids_)(index, 0);
-            double y_dist = (*points_)(index, 1) - (*centroids_)(index, 1);
+            double x_dist = (*points_)(index, 0) - (*centroids_)(k, 0);
+            double y_dist = (*points_)(index, 1) - (*centroids_)(k, 1);
             double dist = x_dist * x_dist + y_dist * y_dist;
             if (dist < optimal_dist) {
                 optimal_dist = dist;
@@ -94,7 +97,9 @@ std::shared_ptr<PatternTree::View<int*>> assignment_;
 
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    Kokkos::ScopeGuard kokkos(argc, argv);
+
 	size_t niters = 100;
     size_t K = 6;
     size_t N = 256;
@@ -120,13 +125,20 @@ int main() {
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 
 	// Optimize and map
-    //PatternTree::StairClimbingOptimizer optimizer;
-    //apt->optimize(optimizer);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
 
 	// Evaluate estimated runtime
-    //PatternTree::RooflineModel model;
-    //double runtime = apt->evaluate(model);
-
-	// TODO: Execute
-	// apt->execute()
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
+
+	// Execute
+    std::vector<double> points_values(N * 2);
+    for (size_t i = 0; i < N; i++) {
+        points_values[i * 2] = (i % 16) / 16.0;
+        points_values[i * 2 + 1] = (i / 16) / 16.0;
+    }
+    std::vector<double> centroids_values(points_values.begin(), points_values.begin() + K * 2);
+    std::vector<int> assignment_values(N, 0);
+    apt->execute({{"points", points_values.data()}, {"centroids", centroids_values.data()}, {"assignment", assignment_values.data()}});
 }
\ No newline at end of file
@@ -6,10 +6,13 @@
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
 
+#include <Kokkos_Core.hpp>
+
 struct MandelbrotFunctor : public PatternTree::MapFunctor<double*> {
     MandelbrotFunctor(int dim0)
     {
@@ -68,7 +71,9 @@ struct MandelbrotFunctor : public PatternTree::MapFunctor<double*> {
 };
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    Kokkos::ScopeGuard kokkos(argc, argv);
+
     size_t N = 1024;
 
 	std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");    
@@ -83,13 +88,14 @@ int main() {
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 
 	// Optimize and map
-    //PatternTree::StairClimbingOptimizer optimizer;
-    //apt->optimize(optimizer);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
 
 	// Evaluate estimated runtime
-    //PatternTree::RooflineModel model;
-    //double runtime = apt->evaluate(model);
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
 
-	// TODO: Execute
-	// apt->execute()
+	// Execute
+    std::vector<double> set_values(N * N, 0.0);
+    apt->execute({{"set", set_values.data()}});
 }
@@ -6,10 +6,13 @@
 #include <cluster/team.h>
 
 #include <optimization/optimizer.h>
+#include <optimization/stair_climbing_optimizer.h>
 
 #include <performance/dataflow_state.h>
 #include <performance/roofline_model.h>
 
+#include <Kokkos_Core.hpp>
+
 struct MXVFunctor : public PatternTree::MapFunctor<double*> {
     
     MXVFunctor(std::shared_ptr<PatternTree::View<double**>> M, std::shared_ptr<PatternTree::View<double*>> x)
@@ -33,7 +36,9 @@ private:
     std::shared_ptr<PatternTree::View<double*>> x_;
 };
 
-int main() {
+int main(int argc, char* argv[]) {
+    Kokkos::ScopeGuard kokkos(argc, argv);
+
 	std::shared_ptr<PatternTree::Cluster> cluster = PatternTree::Cluster::parse("../clusters/cluster_c18g.json");
     
 	// BEGIN APT
@@ -52,13 +57,16 @@ int main() {
     std::unique_ptr<PatternTree::APT> apt = PatternTree::APT::compile();
 
 	// Optimize and map
-    //PatternTree::StairClimbingOptimizer optimizer;
-    //apt->optimize(optimizer);
+    PatternTree::StairClimbingOptimizer optimizer;
+    apt->optimize(optimizer);
 
 	// Evaluate estimated runtime
-    //PatternTree::RooflineModel model;
-    //double runtime = apt->evaluate(model);
+    PatternTree::RooflineModel model;
+    double runtime = apt->evaluate(model);
 
-	// TODO: Execute
-	// apt->execute()
+	// Execute
+    std::vector<double> M_values(256 * 256, 1.0);
+    std::vector<double> x_values(256, 1.0);
+    std::vector<double> res_values(256, 0.0);
+    apt->execute({{"M", M_values.data()}, {"x", x_values.data()}, {"res", res_values.data()}});
 }
\ No newline at end of file